@@ -26,6 +26,7 @@ template<typename... TX> using vector = std::vector<TX...>;
 using vec2  = glm::vec2;
 using ivec2 = glm::ivec2;
 using vec3  = glm::vec3;
+using ivec3 = glm::ivec3;
 using vec4  = glm::vec4;
 using mat3  = glm::mat3;
 using mat4  = glm::mat4;
@@ -0,0 +1,96 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+#include "core/cache_miss_counter.hpp"
+
+#if defined __linux__ && !defined __EMSCRIPTEN__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+#if defined __linux__ && !defined __EMSCRIPTEN__
+
+static int openCacheEvent(uint64_t cache, uint64_t result)
+{
+    perf_event_attr attr{};
+    attr.type           = PERF_TYPE_HW_CACHE;
+    attr.size           = sizeof(attr);
+    attr.config         = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+CacheMissCounter::CacheMissCounter()
+{
+    _eventFds[0] = openCacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS);
+    _eventFds[1] = openCacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_ACCESS);
+    _eventFds[2] = openCacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS);
+    _available   = std::ranges::all_of(_eventFds, [](int fd) { return fd >= 0; });
+}
+
+CacheMissCounter::~CacheMissCounter()
+{
+    for (int fd : _eventFds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+void CacheMissCounter::start()
+{
+    for (int fd : _eventFds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+CacheMissCounter::Counts CacheMissCounter::stop()
+{
+    int64_t values[EventCount] = {};
+    for (int ie = 0; ie < EventCount; ++ie) {
+        if (_eventFds[ie] >= 0) {
+            ioctl(_eventFds[ie], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(_eventFds[ie], &values[ie], sizeof(values[ie])) != sizeof(values[ie])) {
+                values[ie] = 0;
+            }
+        }
+    }
+    return _available ? Counts{values[0], values[1], values[2]} : Counts{};
+}
+
+#else
+
+CacheMissCounter::CacheMissCounter() {}
+
+CacheMissCounter::~CacheMissCounter() {}
+
+void CacheMissCounter::start() {}
+
+CacheMissCounter::Counts CacheMissCounter::stop()
+{
+    return {};
+}
+
+#endif
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,54 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+#pragma once
+
+#include "core/basic_types.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// Counts the data cache misses of the calling thread with the hardware performance counters of the CPU. The counters are only
+// read on Linux, where the kernel may also deny them, e.g. in containers or virtual machines: `available` tells whether they
+// could be opened, and the counts stay zero otherwise.
+//
+class CacheMissCounter
+{
+public:
+    struct Counts {
+        int64_t l1dReadMisses = 0;  // Reads that missed the L1 data cache.
+        int64_t llcReads      = 0;  // Reads that reached the last level cache.
+        int64_t llcReadMisses = 0;  // Reads that missed it too and went to the memory.
+    };
+
+    CacheMissCounter();
+    CacheMissCounter(const CacheMissCounter&)            = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+    ~CacheMissCounter();
+
+    bool available() const noexcept { return _available; }
+
+    // Resets the counts and starts counting.
+    void start();
+
+    // Stops counting and returns the counts since `start`.
+    Counts stop();
+
+private:
+    static const int EventCount = 3;
+
+    int  _eventFds[EventCount] = {-1, -1, -1};
+    bool _available            = false;
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
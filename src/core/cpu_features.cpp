@@ -0,0 +1,101 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "core/cpu_features.hpp"
+
+#if defined _MSC_VER && (defined _M_X64 || defined _M_IX86)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+static SimdIsa querySimdIsa()
+{
+#if (defined __GNUC__ || defined __clang__) && (defined __x86_64__ || defined __i386__)
+    // The builtins also check that the operating system saves the extended registers on context switches.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdIsa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdIsa::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SimdIsa::Sse4;
+    }
+    return SimdIsa::Scalar;
+
+#elif defined _MSC_VER && (defined _M_X64 || defined _M_IX86)
+    int regs[4] = {};
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+
+    __cpuid(regs, 1);
+    const bool hasSse41   = (regs[2] & (1 << 19)) != 0;
+    const bool hasOsxsave = (regs[2] & (1 << 27)) != 0;
+    const bool hasAvx     = (regs[2] & (1 << 28)) != 0;
+
+    // XCR0 tells which register states the operating system saves: bits 1-2 for SSE/AVX and 5-7 for the AVX-512 ones.
+    const uint64_t xcr0          = hasOsxsave ? _xgetbv(0) : 0;
+    const bool     osSavesAvx    = (xcr0 & 0x06) == 0x06;
+    const bool     osSavesAvx512 = (xcr0 & 0xe6) == 0xe6;
+
+    bool hasAvx2    = false;
+    bool hasAvx512f = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        hasAvx2    = (regs[1] & (1 << 5)) != 0;
+        hasAvx512f = (regs[1] & (1 << 16)) != 0;
+    }
+
+    if (hasAvx && hasAvx512f && osSavesAvx512) {
+        return SimdIsa::Avx512;
+    }
+    if (hasAvx && hasAvx2 && osSavesAvx) {
+        return SimdIsa::Avx2;
+    }
+    if (hasSse41) {
+        return SimdIsa::Sse4;
+    }
+    return SimdIsa::Scalar;
+
+#else
+    return SimdIsa::Scalar;
+#endif
+}
+
+SimdIsa detectSimdIsa()
+{
+    static const SimdIsa isa = querySimdIsa();
+    return isa;
+}
+
+const char* simdIsaName(SimdIsa isa)
+{
+    switch (isa) {
+        case SimdIsa::Scalar:
+            return "scalar";
+        case SimdIsa::Sse4:
+            return "sse4";
+        case SimdIsa::Avx2:
+            return "avx2";
+        case SimdIsa::Avx512:
+            return "avx512";
+    }
+    return "?";
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -39,7 +39,7 @@ public:
     void  reset(ivec2 size, const std::optional<T>& clearValue = std::nullopt)
     {
         if (size != _size) {
-            _data.resize(size.x * size.y);
+            _data.resize((size_t)size.x * size.y);
             _size = size;
         }
         if (clearValue) {
@@ -51,27 +51,27 @@ public:
     std::span<T> row(int y) noexcept
     {
         assert(y >= 0 && y < _size.y);
-        return std::span<T>(_data.data() + y * _size.x, _size.x);
+        return std::span<T>(_data.data() + (size_t)y * _size.x, _size.x);
     }
 
     std::span<const T> row(int y) const noexcept
     {
         assert(y >= 0 && y < _size.y);
-        return std::span<const T>(_data.data() + y * _size.x, _size.x);
+        return std::span<const T>(_data.data() + (size_t)y * _size.x, _size.x);
     }
 
     const T& operator()(ivec2 xy) const noexcept
     {
         assert(xy.x >= 0 && xy.x < _size.x);
         assert(xy.y >= 0 && xy.y < _size.y);
-        return _data[xy.x + xy.y * _size.x];
+        return _data[xy.x + (size_t)xy.y * _size.x];
     }
 
     T& operator()(ivec2 xy) noexcept
     {
         assert(xy.x >= 0 && xy.x < _size.x);
         assert(xy.y >= 0 && xy.y < _size.y);
-        return _data[xy.x + xy.y * _size.x];
+        return _data[xy.x + (size_t)xy.y * _size.x];
     }
 };
 
@@ -0,0 +1,112 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#pragma once
+
+#include "core/basic_types.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A matrix class template whose rows hold only their columns from a start of their own to the width of the matrix, stored back
+// to back. The elements are addressed by their coordinates in the full matrix, as in `Matrix`, which lets some rows drop
+// their leading columns, e.g. the finest levels of a history.
+//
+template<typename T> class RaggedMatrix
+{
+    std::vector<T>      _data;
+    std::vector<size_t> _rowBegin = {0};  // The index of the first element of each row in `_data`, and the end of the last row.
+    std::vector<int>    _rowStart;        // The first column held by each row.
+    int                 _width = 0;
+
+public:
+    RaggedMatrix()                               = default;
+    RaggedMatrix(const RaggedMatrix&)            = default;
+    RaggedMatrix(RaggedMatrix&&)                 = default;
+    RaggedMatrix& operator=(const RaggedMatrix&) = default;
+    RaggedMatrix& operator=(RaggedMatrix&&)      = default;
+    ~RaggedMatrix()                              = default;
+    RaggedMatrix(int width, std::span<const int> rowStarts, const std::optional<T>& initValue = std::nullopt) { reset(width, rowStarts, initValue); }
+
+    int    width() const noexcept { return _width; }
+    int    rowCount() const noexcept { return (int)_rowStart.size(); }
+    int    rowStart(int y) const noexcept { return _rowStart[y]; }
+    size_t elementCount() const noexcept { return _data.size(); }
+
+    // The index of the first element of each row among all the elements, and the end of the last row.
+    const size_t* rowBegins() const noexcept { return _rowBegin.data(); }
+
+    void reset(int width, std::span<const int> rowStarts, const std::optional<T>& clearValue = std::nullopt)
+    {
+        _width = width;
+        _rowStart.assign(rowStarts.begin(), rowStarts.end());
+        _rowBegin.resize(rowStarts.size() + 1);
+        for (size_t y = 0; y < rowStarts.size(); ++y) {
+            assert(rowStarts[y] >= 0 && rowStarts[y] <= width);
+            _rowBegin[y + 1] = _rowBegin[y] + (width - rowStarts[y]);
+        }
+        _data.resize(_rowBegin.back());
+        if (clearValue) {
+            clear(*clearValue);
+        }
+    }
+    void clear(const T& value = T{}) noexcept { std::fill(_data.begin(), _data.end(), value); }
+
+    // Keeps the rows at the given increasing indices, moved forward in place with their starts, and drops the others.
+    void keepRows(std::span<const int> rows)
+    {
+        assert(std::ranges::is_sorted(rows) && (rows.empty() || rows.back() < rowCount()));
+        size_t begin = 0;
+        for (size_t y = 0; y < rows.size(); ++y) {
+            const auto kept = row(rows[y]);
+            std::copy(kept.begin(), kept.end(), _data.begin() + begin);
+            _rowStart[y] = _rowStart[rows[y]];
+            _rowBegin[y] = begin;
+            begin += kept.size();
+        }
+        _rowStart.resize(rows.size());
+        _rowBegin.resize(rows.size() + 1);
+        _rowBegin.back() = begin;
+        _data.resize(begin);
+    }
+
+    // The columns held by a row, from `rowStart(y)`.
+    std::span<T> row(int y) noexcept
+    {
+        assert(y >= 0 && y < rowCount());
+        return std::span<T>(_data.data() + _rowBegin[y], _rowBegin[y + 1] - _rowBegin[y]);
+    }
+
+    std::span<const T> row(int y) const noexcept
+    {
+        assert(y >= 0 && y < rowCount());
+        return std::span<const T>(_data.data() + _rowBegin[y], _rowBegin[y + 1] - _rowBegin[y]);
+    }
+
+    const T& operator()(ivec2 xy) const noexcept
+    {
+        assert(xy.y >= 0 && xy.y < rowCount());
+        assert(xy.x >= _rowStart[xy.y] && xy.x < _width);
+        return _data[_rowBegin[xy.y] + (xy.x - _rowStart[xy.y])];
+    }
+
+    T& operator()(ivec2 xy) noexcept
+    {
+        assert(xy.y >= 0 && xy.y < rowCount());
+        assert(xy.x >= _rowStart[xy.y] && xy.x < _width);
+        return _data[_rowBegin[xy.y] + (xy.x - _rowStart[xy.y])];
+    }
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,188 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#pragma once
+
+#include "core/basic_types.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// An allocator which places the arrays at the given alignment, e.g. at the start of a cache line.
+//
+template<typename T, size_t Alignment> struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U> struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template<typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T*   allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment})); }
+    void deallocate(T* ptr, size_t) noexcept { ::operator delete(ptr, std::align_val_t{Alignment}); }
+
+    template<typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A structure-of-arrays container template which stores each field of a record in its own array, so that a loop touching only
+// some of the fields does not pull the others through the cache. The fields are given as pointers to the members of the record,
+// which remains the type used to pass whole elements in and out.
+//
+// Each array starts at a cache line and is padded to a whole number of cache lines. The padding elements are kept
+// value-initialized, so vectorized loops may run past the end in full lanes (e.g. over zero masses).
+//
+// Usage:
+//      SoaVector<&Body::pos, &Body::mass> bodies;
+//      bodies.push_back(Body{...});
+//      std::span<vec3> positions = bodies.field<&Body::pos>();
+//
+template<auto... Fields> class SoaVector
+{
+    template<typename M> struct MemberTraits;
+    template<typename R, typename T> struct MemberTraits<T R::*> {
+        using Record = R;
+        using Type   = T;
+    };
+
+    template<auto Field> using FieldType = typename MemberTraits<decltype(Field)>::Type;
+
+public:
+    using Record = typename MemberTraits<std::tuple_element_t<0, std::tuple<decltype(Fields)...>>>::Record;
+
+    constexpr static const size_t Alignment    = 64;
+    constexpr static const int    PaddingCount = Alignment / sizeof(float);  // Elements of at least 4 bytes fill whole cache lines.
+
+private:
+    std::tuple<std::vector<FieldType<Fields>, AlignedAllocator<FieldType<Fields>, Alignment>>...> _arrays;
+    int                                                                                              _size = 0;
+
+public:
+    int  size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+
+    // Returns the number of elements the arrays hold including the padding, i.e. `size()` rounded up to a multiple of `PaddingCount`.
+    int paddedSize() const noexcept { return paddedCount(_size); }
+
+    void clear() noexcept { resize(0); }
+
+    void resize(int size)
+    {
+        assert(size >= 0);
+        forEachArray([&](auto& array) {
+            using T = typename std::decay_t<decltype(array)>::value_type;
+            std::fill(array.begin() + std::min(size, _size), array.begin() + std::min<int>(_size, (int)array.size()), T{});
+            array.resize(paddedCount(size), T{});
+        });
+        _size = size;
+    }
+
+    void assign(std::span<const Record> records)
+    {
+        resize((int)records.size());
+        for (int i = 0; i < _size; ++i) {
+            set(i, records[i]);
+        }
+    }
+
+    void push_back(const Record& record)
+    {
+        if (_size == paddedSize()) {
+            forEachArray([&](auto& array) {
+                using T = typename std::decay_t<decltype(array)>::value_type;
+                array.resize(paddedCount(_size + 1), T{});
+            });
+        }
+        set(_size++, record);
+    }
+
+    // Reorders the elements, so that the element at index `i` is the one which was at index `order[i]`.
+    void permute(std::span<const int> order)
+    {
+        assert((int)order.size() == _size);
+        forEachArray([&](auto& array) {
+            auto permuted = array;
+            for (int i = 0; i < _size; ++i) {
+                permuted[i] = array[order[i]];
+            }
+            array = std::move(permuted);
+        });
+    }
+
+    // Keeps the elements at the given increasing indices, moved forward in place, and drops the others.
+    void keep(std::span<const int> indices)
+    {
+        assert(std::ranges::is_sorted(indices) && (indices.empty() || indices.back() < _size));
+        forEachArray([&](auto& array) {
+            for (int i = 0; i < (int)indices.size(); ++i) {
+                array[i] = array[indices[i]];
+            }
+        });
+        resize((int)indices.size());
+    }
+
+    // Gathers the fields of the element at index `i` into a record.
+    Record operator[](int i) const
+    {
+        assert(i >= 0 && i < _size);
+        Record record{};
+        ((record.*Fields = field<Fields>()[i]), ...);
+        return record;
+    }
+
+    // Scatters the fields of `record` into the element at index `i`.
+    void set(int i, const Record& record)
+    {
+        assert(i >= 0 && i < _size);
+        ((field<Fields>()[i] = record.*Fields), ...);
+    }
+
+    template<auto Field> std::span<FieldType<Field>> field() noexcept { return std::span{std::get<fieldIndex<Field>()>(_arrays).data(), (size_t)_size}; }
+    template<auto Field> std::span<const FieldType<Field>> field() const noexcept { return std::span{std::get<fieldIndex<Field>()>(_arrays).data(), (size_t)_size}; }
+
+    // Returns the array of the field including the padding elements, which must stay value-initialized.
+    template<auto Field> std::span<FieldType<Field>> paddedField() noexcept { return std::span{std::get<fieldIndex<Field>()>(_arrays)}; }
+    template<auto Field> std::span<const FieldType<Field>> paddedField() const noexcept { return std::span{std::get<fieldIndex<Field>()>(_arrays)}; }
+
+private:
+    static int paddedCount(int count) noexcept { return (count + PaddingCount - 1) / PaddingCount * PaddingCount; }
+
+    template<typename Fn> void forEachArray(Fn&& fn)
+    {
+        std::apply([&](auto&... arrays) { (fn(arrays), ...); }, _arrays);
+    }
+
+    template<auto A, auto B> constexpr static bool isSameField()
+    {
+        if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+            return A == B;
+        } else {
+            return false;
+        }
+    }
+
+    template<auto Field> constexpr static size_t fieldIndex()
+    {
+        size_t index = 0;
+        size_t found = sizeof...(Fields);
+        ((isSameField<Field, Fields>() ? (found = index, ++index) : ++index), ...);
+        static_assert(sizeof...(Fields) > 0);
+        return found;
+    }
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,242 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "core/thread_pool.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+namespace {
+
+// The pool whose worker runs on this thread, and the index of the worker. Other threads use the queue of the owner thread.
+thread_local const ThreadPool* tl_pool      = nullptr;
+thread_local int               tl_workerIdx = 0;
+
+// The number of tasks being run by this thread: a task waiting for nested work runs other tasks meanwhile.
+thread_local int tl_taskDepth = 0;
+
+}  // namespace
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+ThreadPool::ThreadPool(int threadCount)
+{
+    threadCount = std::max(1, threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    resetWorkerStats();
+
+    for (int i = 1; i < threadCount; ++i) {
+        _threads.emplace_back([this, i] { runWorker(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(_sleepMutex);
+        _quit = true;
+    }
+    _wakeCondition.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(int count, int chunkSize, const ChunkFn& fn)
+{
+    assert(chunkSize > 0);
+    if (count <= 0) {
+        return;
+    }
+
+    const int chunkCount = (count + chunkSize - 1) / chunkSize;
+    if (_threads.empty() || chunkCount == 1) {
+        runTask([&] { fn(0, count); }, false);
+        return;
+    }
+
+    // Each task keeps taking the next chunk until none is left, so there are never more tasks than threads.
+    std::atomic<int> nextIdx   = 0;
+    const auto       runChunks = [&] {
+        while (true) {
+            const int begin = nextIdx.fetch_add(chunkSize, std::memory_order_relaxed);
+            if (begin >= count) {
+                break;
+            }
+            fn(begin, std::min(begin + chunkSize, count));
+        }
+    };
+
+    TaskGroup group(*this);
+    for (int i = 1; i < std::min(threadCount(), chunkCount); ++i) {
+        group.run(runChunks);
+    }
+    runTask(runChunks, false);
+    group.wait();
+}
+
+vector<ThreadPool::WorkerStats> ThreadPool::workerStats() const
+{
+    const double elapsedSeconds = std::chrono::duration<double>(Clock::now() - _statsStartTime).count();
+
+    vector<WorkerStats> stats;
+    for (const auto& worker : _workers) {
+        WorkerStats& workerStats = stats.emplace_back();
+        workerStats.taskCount    = worker->taskCount.load(std::memory_order_relaxed);
+        workerStats.stealCount   = worker->stealCount.load(std::memory_order_relaxed);
+        workerStats.busySeconds  = 1e-9 * (double)worker->busyNs.load(std::memory_order_relaxed);
+        workerStats.utilization  = (elapsedSeconds > 0.0) ? (float)(workerStats.busySeconds / elapsedSeconds) : 0.0f;
+    }
+    return stats;
+}
+
+void ThreadPool::resetWorkerStats()
+{
+    for (auto& worker : _workers) {
+        worker->taskCount.store(0, std::memory_order_relaxed);
+        worker->stealCount.store(0, std::memory_order_relaxed);
+        worker->busyNs.store(0, std::memory_order_relaxed);
+    }
+    _statsStartTime = Clock::now();
+}
+
+int ThreadPool::hardwareThreadCount()
+{
+#if defined __EMSCRIPTEN__ && !defined __EMSCRIPTEN_PTHREADS__
+    return 1;
+#else
+    return std::max(1, (int)std::thread::hardware_concurrency());
+#endif
+}
+
+void ThreadPool::push(Task task)
+{
+    Worker& worker = *_workers[currentWorkerIdx()];
+    {
+        std::lock_guard lock(worker.queueMutex);
+        worker.queue.push_back(std::move(task));
+    }
+    _queuedTaskCount.fetch_add(1);
+
+    if (!_threads.empty()) {
+        // Synchronizes with a worker about to sleep, which checks the count under the lock.
+        {
+            std::lock_guard lock(_sleepMutex);
+        }
+        _wakeCondition.notify_one();
+    }
+}
+
+// Runs the newest task of the current thread, or else steals the oldest task of another thread.
+// Returns false if all the queues are empty.
+//
+bool ThreadPool::tryRunTask()
+{
+    if (_queuedTaskCount.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    const int workerIdx   = currentWorkerIdx();
+    const int workerCount = threadCount();
+
+    std::optional<Task> task;
+    bool                stolen = false;
+    {
+        Worker&         worker = *_workers[workerIdx];
+        std::lock_guard lock(worker.queueMutex);
+        if (!worker.queue.empty()) {
+            task.emplace(std::move(worker.queue.back()));
+            worker.queue.pop_back();
+        }
+    }
+    for (int i = 1; !task && i < workerCount; ++i) {
+        Worker&         victim = *_workers[(workerIdx + i) % workerCount];
+        std::lock_guard lock(victim.queueMutex);
+        if (!victim.queue.empty()) {
+            task.emplace(std::move(victim.queue.front()));
+            victim.queue.pop_front();
+            stolen = true;
+        }
+    }
+    if (!task) {
+        return false;
+    }
+    _queuedTaskCount.fetch_sub(1, std::memory_order_relaxed);
+
+    runTask(task->fn, stolen);
+    task->group->_pendingCount.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+// Runs a task on the current thread, counting its time unless it is nested in another task.
+//
+void ThreadPool::runTask(const TaskFn& fn, bool stolen)
+{
+    Worker& worker = *_workers[currentWorkerIdx()];
+
+    const auto startTime = Clock::now();
+    ++tl_taskDepth;
+    fn();
+    --tl_taskDepth;
+
+    if (tl_taskDepth == 0) {
+        worker.busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count(), std::memory_order_relaxed);
+    }
+    worker.taskCount.fetch_add(1, std::memory_order_relaxed);
+    if (stolen) {
+        worker.stealCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ThreadPool::runWorker(int workerIdx)
+{
+    tl_pool      = this;
+    tl_workerIdx = workerIdx;
+
+    while (true) {
+        if (tryRunTask()) {
+            continue;
+        }
+
+        std::unique_lock lock(_sleepMutex);
+        _wakeCondition.wait(lock, [&] { return _quit || _queuedTaskCount.load() > 0; });
+        if (_quit) {
+            return;
+        }
+    }
+}
+
+int ThreadPool::currentWorkerIdx() const { return (tl_pool == this) ? tl_workerIdx : 0; }
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+void TaskGroup::run(ThreadPool::TaskFn fn)
+{
+    _pendingCount.fetch_add(1, std::memory_order_relaxed);
+    _pool.push({std::move(fn), this});
+}
+
+void TaskGroup::wait()
+{
+    while (_pendingCount.load(std::memory_order_acquire) > 0) {
+        if (!_pool.tryRunTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,132 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#pragma once
+
+#include "core/basic_types.hpp"
+#include "core/clock.hpp"
+
+class TaskGroup;
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A work-stealing pool of worker threads, which run tasks together with the thread that owns the pool.
+// Each thread has its own queue: it runs its own tasks in the LIFO order, while the idle threads steal the oldest tasks of the others.
+// A thread waiting for a group of tasks runs the queued tasks meanwhile, so the tasks may spawn and wait for nested work.
+//
+// Usage:
+//      ThreadPool pool(8);
+//      pool.parallelFor(bodyCount, 64, [&](int begin, int end) { ... });
+//
+//      TaskGroup group(pool);
+//      group.run([&] { ... });
+//      group.run([&] { ... });
+//      group.wait();
+//
+class ThreadPool
+{
+    friend class TaskGroup;
+
+public:
+    using TaskFn  = std::function<void()>;
+    using ChunkFn = std::function<void(int begin, int end)>;
+
+    // The counters of a thread since the last `resetWorkerStats`.
+    //
+    struct WorkerStats {
+        uint64_t taskCount   = 0;     // Tasks run by the thread.
+        uint64_t stealCount  = 0;     // Tasks taken from the queues of the other threads.
+        double   busySeconds = 0.0;   // Time spent running the tasks, including their waits for nested tasks.
+        float    utilization = 0.0f;  // Busy time relative to the time elapsed since the reset.
+    };
+
+private:
+    struct Task {
+        TaskFn     fn;
+        TaskGroup* group;
+    };
+
+    // The queue and the counters of a thread. The first one belongs to the owner thread, the others to the workers.
+    struct alignas(64) Worker {
+        std::mutex            queueMutex;
+        std::deque<Task>      queue;
+        std::atomic<uint64_t> taskCount  = 0;
+        std::atomic<uint64_t> stealCount = 0;
+        std::atomic<uint64_t> busyNs     = 0;
+    };
+
+    vector<uptr<Worker>>    _workers;
+    vector<std::thread>     _threads;
+    std::atomic<int>        _queuedTaskCount = 0;
+    std::mutex              _sleepMutex;
+    std::condition_variable _wakeCondition;
+    bool                    _quit = false;
+    Clock::time_point       _statsStartTime;
+
+public:
+    // Starts `threadCount - 1` workers, as the owner thread takes part in the work as well.
+    explicit ThreadPool(int threadCount);
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    int threadCount() const noexcept { return (int)_workers.size(); }
+
+    // Calls `fn(begin, end)` for chunks of at most `chunkSize` iterations covering [0, count), and returns once all are done.
+    // The chunks are handed out on demand, so that the threads which get cheaper chunks simply take more of them.
+    void parallelFor(int count, int chunkSize, const ChunkFn& fn);
+
+    // The counters of each thread, starting with the owner thread.
+    vector<WorkerStats> workerStats() const;
+    void                resetWorkerStats();
+
+    // Returns the number of threads the hardware runs concurrently, or 1 where threads are not available.
+    static int hardwareThreadCount();
+
+private:
+    void push(Task task);
+    bool tryRunTask();
+    void runTask(const TaskFn& fn, bool stolen);
+    void runWorker(int workerIdx);
+    int  currentWorkerIdx() const;
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A set of tasks run by a pool, which can be waited for together. The destructor waits for the tasks still running.
+//
+class TaskGroup
+{
+    friend class ThreadPool;
+
+    ThreadPool&      _pool;
+    std::atomic<int> _pendingCount = 0;
+
+public:
+    explicit TaskGroup(ThreadPool& pool)
+        : _pool{pool}
+    {
+    }
+    TaskGroup(const TaskGroup&)            = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    ~TaskGroup() { wait(); }
+
+    void run(ThreadPool::TaskFn fn);
+
+    // Returns once all the tasks of the group are done, running the queued tasks of the pool meanwhile.
+    void wait();
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
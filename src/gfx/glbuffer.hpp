@@ -36,6 +36,7 @@ public:
     void   setData(std::span<const std::byte> dataView);
 
     template<typename T> void setData(const std::vector<T>& data) { setData(std::as_bytes(std::span{data})); }
+    template<typename T> void setData(std::span<const T> data) { setData(std::as_bytes(data)); }
 };
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
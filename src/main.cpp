@@ -14,14 +14,20 @@
 */
 
 #include "app.hpp"
+#include "nbody/nbody_bench.hpp"
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
 
 // The main program's entry point.
+// Runs the interactive demo, or a headless benchmark if invoked with `--bench`.
 //
 int main(int argc, char* args[])
 {
     try {
+        if (argc > 1 && std::string_view{args[1]} == "--bench") {
+            return runNBodyBench(std::span{args + 2, args + argc});
+        }
+
         App app;
         app.run();
         return 0;
@@ -0,0 +1,66 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "nbody/galaxy_generator.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+vector<NBodySim::Body> generateDiscGalaxy(std::mt19937& re, int bodyCount, int tracerCount)
+{
+    vector<NBodySim::Body> bodies;
+    bodies.reserve(bodyCount + tracerCount);
+
+    std::uniform_real_distribution<float> radiusDis(1.5f, 5.0f);
+    std::uniform_real_distribution<float> velDis(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> massDis(0.01f, 0.5f);
+
+    bodies.push_back(NBodySim::Body{
+        .pos  = vec3{0.0f, 0.0f, 0.0f},
+        .vel  = vec3{0.0f, 0.0f, 0.0f},
+        .mass = 5.0f,
+    });
+
+    const int bc = bodyCount - 1;
+    for (int i = 0; i < bc; ++i) {
+        const float alpha  = (float)i * 2.0f * glm::pi<float>() / (float)bc;
+        const float radius = radiusDis(re);
+        const float mass   = massDis(re) * massDis(re) * massDis(re) / radius;
+
+        NBodySim::Body body{
+            .pos  = radius * vec3{cos(alpha), 0.0f, sin(alpha)},
+            .vel  = 1.0f * vec3{-sin(alpha), 0.5f * velDis(re), cos(alpha)},
+            .mass = mass,
+        };
+
+        bodies.push_back(std::move(body));
+    }
+
+    for (int i = 0; i < tracerCount; ++i) {
+        const float alpha  = (float)i * 2.0f * glm::pi<float>() / (float)tracerCount;
+        const float radius = radiusDis(re);
+
+        NBodySim::Body body{
+            .pos  = radius * vec3{cos(alpha), 0.0f, sin(alpha)},
+            .vel  = 1.0f * vec3{-sin(alpha), 0.5f * velDis(re), cos(alpha)},
+            .mass = 0.0f,
+        };
+
+        bodies.push_back(std::move(body));
+    }
+
+    return bodies;
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -121,7 +121,7 @@ StarRenderer::StarRenderer()
     _quadVertexBuffer.setData(quadVertices);
 }
 
-void StarRenderer::updatePositions(const vector<vec3>& particlePositions)
+void StarRenderer::updatePositions(std::span<const vec3> particlePositions)
 {
     static_assert(sizeof(vec3) == 3 * sizeof(GLfloat));
     _particlePosBuffer.setData(particlePositions);
@@ -290,11 +290,7 @@ GalaxyRenderer::~GalaxyRenderer() {}
 
 void GalaxyRenderer::setSonarRadius(float radius) { _sonarRenderer.setSonarRadius(radius); }
 
-void GalaxyRenderer::updateParticlePositions(const vector<vec3>& particlePositions)
-{
-    _galaxyCenter = particlePositions.empty() ? vec3{} : particlePositions[0];
-    _starRenderer.updatePositions(particlePositions);
-}
+void GalaxyRenderer::updateParticlePositions(std::span<const vec3> particlePositions) { _starRenderer.updatePositions(particlePositions); }
 
 void GalaxyRenderer::updateParticleSizes(const vector<float>& particleSizes) { _starRenderer.updateSizes(particleSizes); }
 
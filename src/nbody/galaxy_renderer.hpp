@@ -62,7 +62,7 @@ class StarRenderer
 
 public:
     StarRenderer();
-    void updatePositions(const vector<vec3>& particlePositions);
+    void updatePositions(std::span<const vec3> particlePositions);
     void updateSizes(const vector<float>& particleSizes);
     void updateColors(const vector<vec3>& particleColors);
     void draw(const mat4& viewMat, const mat4& projMat);
@@ -113,7 +113,8 @@ public:
     ~GalaxyRenderer();
 
     void setSonarRadius(float radius);
-    void updateParticlePositions(const vector<vec3>& particlePositions);
+    void setGalaxyCenter(const vec3& center) { _galaxyCenter = center; }
+    void updateParticlePositions(std::span<const vec3> particlePositions);
     void updateParticleSizes(const vector<float>& particleSizes);
     void updateParticleColors(const vector<vec3>& particleColors);
     void draw();
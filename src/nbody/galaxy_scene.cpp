@@ -17,14 +17,28 @@
 
 #include "core/clock.hpp"
 #include "gfx/display_window.hpp"
+#include "nbody/galaxy_generator.hpp"
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
 
 #ifdef __EMSCRIPTEN__
 
-void respawnScenario() { GalaxyScene::get().spawnScenario(); }
+void respawnScenario() { GalaxyScene::get().respawnScenario(); }
+void cycleForceSolver() { GalaxyScene::get().cycleForceSolver(); }
+void toggleForceErrorReport() { GalaxyScene::get().toggleForceErrorReport(); }
+void toggleThreadUseReport() { GalaxyScene::get().toggleThreadUseReport(); }
+void toggleMerging() { GalaxyScene::get().toggleMerging(); }
+void toggleEscaperRemoval() { GalaxyScene::get().toggleEscaperRemoval(); }
 
-EMSCRIPTEN_BINDINGS(Isamerion) { function("respawnScenario", &respawnScenario); }
+EMSCRIPTEN_BINDINGS(Isamerion)
+{
+    function("respawnScenario", &respawnScenario);
+    function("cycleForceSolver", &cycleForceSolver);
+    function("toggleForceErrorReport", &toggleForceErrorReport);
+    function("toggleThreadUseReport", &toggleThreadUseReport);
+    function("toggleMerging", &toggleMerging);
+    function("toggleEscaperRemoval", &toggleEscaperRemoval);
+}
 
 #endif
 
@@ -35,6 +49,7 @@ GalaxyScene::GalaxyScene(DisplayWindow& displayWindow)
     , _galaxyRenderer{_displayWindow}
     , _sim{}
 {
+    _sim.setKeepEscapedMass(true);
     spawnScenario();
 }
 
@@ -43,38 +58,34 @@ GalaxyScene::~GalaxyScene() {}
 void GalaxyScene::spawnScenario(int scenarioId)
 {
     vector<NBodySim::Body> bodies;
+    NBodySim::ForceSolver  forceSolver{};
+    NBodySim::ExactSearch  exactSearch = NBodySim::ExactSearch::Cached;
 
     switch (scenarioId) {
         case 0: {
-            bodies.clear();
-            bodies.reserve(128);
-
-            static std::mt19937                   re(0);
-            std::uniform_real_distribution<float> radiusDis(1.5f, 5.0f);
-            std::uniform_real_distribution<float> velDis(-1.0f, 1.0f);
-            std::uniform_real_distribution<float> massDis(0.01f, 0.5f);
-
-            bodies.push_back(NBodySim::Body{
-                .pos  = vec3{0.0f, 0.0f, 0.0f},
-                .vel  = vec3{0.0f, 0.0f, 0.0f},
-                .mass = 5.0f,
-            });
-
-            const int bc = 127;
-            for (int i = 0; i < bc; ++i) {
-                const float alpha  = (float)i * 2.0f * glm::pi<float>() / (float)bc;
-                const float radius = radiusDis(re);
-                const float mass   = massDis(re) * massDis(re) * massDis(re) / radius;
-
-                NBodySim::Body body{
-                    .pos  = radius * vec3{cos(alpha), 0.0f, sin(alpha)},
-                    .vel  = 1.0f * vec3{-sin(alpha), 0.5f * velDis(re), cos(alpha)},
-                    .mass = mass,
-                };
+            // A small disc, simulated exactly.
+            static std::mt19937 re(0);
+            bodies      = generateDiscGalaxy(re, 128);
+            forceSolver = NBodySim::ForceSolver::Exact;
+            break;
+        }
 
-                bodies.push_back(std::move(body));
-            }
+        case 1: {
+            // A large disc, which is only tractable with an approximate solver.
+            static std::mt19937 re(0);
+            bodies      = generateDiscGalaxy(re, 16384);
+            forceSolver = NBodySim::ForceSolver::BarnesHut;
+            break;
+        }
 
+        case 2: {
+            // A disc of massless tracers around a smaller one of massive bodies, which only the massive ones attract: simulated
+            // exactly, as the cost grows with the pairs of a massive body and any other. The searches start from the distances
+            // of the pairs rather than from a cache entry of each, which would not fit in memory. They find the same crossings.
+            static std::mt19937 re(0);
+            bodies      = generateDiscGalaxy(re, 2048, 30720);
+            forceSolver = NBodySim::ForceSolver::Exact;
+            exactSearch = NBodySim::ExactSearch::Cacheless;
             break;
         }
 
@@ -83,28 +94,112 @@ void GalaxyScene::spawnScenario(int scenarioId)
         }
     }
 
-    _sim.respawn(std::move(bodies));
-    regenerateStarSizesAndColors();
+    _scenarioId = scenarioId;
+    _sim.setExactSearch(exactSearch);
+    _sim.respawn(bodies, forceSolver);
+    regenerateStarColors();
 }
 
+void GalaxyScene::cycleForceSolver()
+{
+    auto forceSolver = NBodySim::ForceSolver::Exact;
+    switch (_sim.forceSolver()) {
+        case NBodySim::ForceSolver::Exact:
+            forceSolver = NBodySim::ForceSolver::BarnesHut;
+            break;
+        case NBodySim::ForceSolver::BarnesHut:
+            forceSolver = NBodySim::ForceSolver::Fmm;
+            break;
+        case NBodySim::ForceSolver::Fmm:
+            forceSolver = NBodySim::ForceSolver::Newtonian;
+            break;
+        case NBodySim::ForceSolver::Newtonian:
+            forceSolver = NBodySim::ForceSolver::Analytic;
+            break;
+        case NBodySim::ForceSolver::Analytic:
+            forceSolver = NBodySim::ForceSolver::Exact;
+            break;
+    }
+
+    // The exact and analytic solvers visit each pair of a source and another body, which is too slow for large systems, unless
+    // most of their bodies are tracers.
+    if ((forceSolver == NBodySim::ForceSolver::Exact || forceSolver == NBodySim::ForceSolver::Analytic) && (int64_t)_sim.bodyCount() * _sim.sourceCount() > MAX_EXACT_SOLVER_PAIR_COUNT) {
+        forceSolver = NBodySim::ForceSolver::BarnesHut;
+    }
+
+    _sim.setForceSolver(forceSolver);
+}
+
+// Toggles the comparison mode of the simulation, which periodically prints the error of the active solver to the console.
+//
+void GalaxyScene::toggleForceErrorReport()
+{
+    _reportForceError = !_reportForceError;
+    _sim.setForceErrorSampleCount(_reportForceError ? FORCE_ERROR_SAMPLE_COUNT : 0);
+}
+
+// Toggles the periodic report of the share of time each thread of the simulation spends on tasks.
+//
+void GalaxyScene::toggleThreadUseReport()
+{
+    _reportThreadUse = !_reportThreadUse;
+    _sim.threadPool().resetWorkerStats();
+}
+
+// Toggles the merging of the bodies which touch. The merged bodies disappear, and the sizes of the others follow their masses.
+//
+void GalaxyScene::toggleMerging() { _sim.setMergeOnContact(!_sim.mergeOnContact()); }
+
+// Toggles the removal of the stars which escape beyond `ESCAPE_RADIUS`. Their mass keeps pulling the remaining ones.
+//
+void GalaxyScene::toggleEscaperRemoval() { _sim.setEscapeRadius((_sim.escapeRadius() > 0.0f) ? 0.0f : ESCAPE_RADIUS); }
+
+// Draws the current state of the simulation, while the next step is computed by the thread pool in the background.
+// The renderer gets a copy of the positions, as the step moves the bodies during the frame.
+//
 void GalaxyScene::onTick(uint64_t tickCount, float dt)
 {
-    if (tickCount != 0) {
-        _sim.step(dt);
+    if (_reportForceError && tickCount % FORCE_ERROR_REPORT_INTERVAL == 0) {
+        const auto stats = _sim.forceErrorStats();
+        std::cout << "force error: rms " << stats.rmsRelError << ", max " << stats.maxRelError << " (" << stats.sampleCount << " samples)" << std::endl;
+    }
+
+    if (_reportThreadUse && tickCount % THREAD_REPORT_INTERVAL == 0) {
+        printThreadUse();
     }
 
-    static vector<vec3> particlePositions;
-    particlePositions.clear();
-    particlePositions.reserve(_sim._bodies.size());
-    for (const auto& body : _sim._bodies) {
-        particlePositions.push_back(body.pos);
+    // The pairs out of the history exert no force until the adaptive depth catches up, or at all with a fixed one.
+    if (tickCount % HISTORY_REPORT_INTERVAL == 0 && _sim.outOfWindowCount() > 0) {
+        std::cout << "history too short: " << _sim.outOfWindowCount() << " pairs out of " << _sim.historyRecordCount() << " records" << std::endl;
     }
 
-    _galaxyRenderer.updateParticlePositions(particlePositions);
+    // The sizes and colors follow the bodies, which the last step may have reordered or merged.
+    if (_sim.reorderCount() != _starReorderCount) {
+        uploadStarSizesAndColors();
+    }
+
+    const auto bodyPositions = _sim.bodyPositions();
+    _framePositions.resize(bodyPositions.size());
+    _sim.threadPool().parallelFor((int)bodyPositions.size(), POSITION_PACK_CHUNK_SIZE, [&](int begin, int end) {
+        std::copy(bodyPositions.begin() + begin, bodyPositions.begin() + end, _framePositions.begin() + begin);
+    });
+    const float simTime = _sim.simTime();
+
+    // The camera follows the central mass of the disc, spawned first, as long as it remains.
+    if (const int centerIdx = _sim.bodyIndex(0); centerIdx >= 0) {
+        _galaxyRenderer.setGalaxyCenter(bodyPositions[centerIdx]);
+    }
+
+    TaskGroup simTasks(_sim.threadPool());
+    if (tickCount != 0) {
+        simTasks.run([this, dt] { _sim.step(dt); });
+    }
+
+    _galaxyRenderer.updateParticlePositions(_framePositions);
 
     {
         constexpr float sonarPulseTimeWrap = 5.0f;
-        const float     ltd                = std::fmod(_sim.simTime(), sonarPulseTimeWrap) * _sim.LightSpeed;
+        const float     ltd                = std::fmod(simTime, sonarPulseTimeWrap) * _sim.LightSpeed;
         _galaxyRenderer.setSonarRadius(ltd);
     }
 
@@ -113,6 +208,8 @@ void GalaxyScene::onTick(uint64_t tickCount, float dt)
         _galaxyRenderer.draw();
         _displayWindow.endFrame();
     }
+
+    simTasks.wait();
 }
 
 bool GalaxyScene::handleEvent(const SDL_Event& generalEvent)
@@ -128,40 +225,91 @@ bool GalaxyScene::handleEvent(const SDL_Event& generalEvent)
 
 void GalaxyScene::handleKeyboardEvent(const SDL_KeyboardEvent& keyboardEvent)
 {
-    if (keyboardEvent.keysym.scancode == SDL_SCANCODE_R) {
-        spawnScenario();
+    if (keyboardEvent.type != SDL_KEYDOWN) {
+        return;
+    }
+
+    switch (keyboardEvent.keysym.scancode) {
+        case SDL_SCANCODE_R:
+            respawnScenario();
+            break;
+        case SDL_SCANCODE_N:
+            spawnScenario((_scenarioId + 1) % SCENARIO_COUNT);
+            break;
+        case SDL_SCANCODE_M:
+            cycleForceSolver();
+            break;
+        case SDL_SCANCODE_C:
+            toggleForceErrorReport();
+            break;
+        case SDL_SCANCODE_T:
+            toggleThreadUseReport();
+            break;
+        case SDL_SCANCODE_G:
+            toggleMerging();
+            break;
+        case SDL_SCANCODE_E:
+            toggleEscaperRemoval();
+            break;
+        default:
+            break;
     }
 }
 
-void GalaxyScene::regenerateStarSizesAndColors()
+void GalaxyScene::regenerateStarColors()
 {
-    constexpr float BodyDensity = 1.0f;
-
     const vec3 bluePoint{111 / 255.0f, 140 / 255.0f, 199 / 255.0f};
     const vec3 redPoint{255 / 255.0f, 255 / 255.0f, 0 / 255.0f};
     const vec3 yellowPoint{189 / 255.0f, 57 / 255.0f, 54 / 255.0f};
 
-    vector<float> particleSizes;
-    vector<vec3>  particleColors;
-    particleSizes.reserve(_sim._bodies.size());
-    particleColors.reserve(_sim._bodies.size());
+    _starColors.clear();
+    _starColors.reserve(_sim.bodyCount());
 
     static std::mt19937                   re(0);
     std::uniform_real_distribution<float> uniformDis(0.0f, 1.0f);
 
-    for (const auto& body : _sim._bodies) {
-        const float volume = body.mass / BodyDensity;
-        const float radius = std::cbrt(3.0f / (4.0f * glm::pi<float>()) * volume);
-        particleSizes.push_back(radius);
-
+    for (int bodyId = 0; bodyId < _sim.bodyCount(); ++bodyId) {
         const float alpha     = uniformDis(re);
         const float beta      = uniformDis(re);
         const vec3  starColor = (bluePoint * (1.0f - alpha) + redPoint * alpha) * (1.0f - beta) + yellowPoint * beta;
 
-        particleColors.push_back(starColor);
+        _starColors.push_back(starColor);
+    }
+    uploadStarSizesAndColors();
+}
+
+// Uploads the sizes and colors of the stars in the current order of the bodies. The sizes are the radii of the bodies, which
+// grow with their masses as they merge.
+//
+void GalaxyScene::uploadStarSizesAndColors()
+{
+    constexpr float TracerStarMass = 1e-4f;  // The tracers are massless, but still drawn as light stars.
+
+    const auto bodyIds    = _sim.bodyIds();
+    const auto bodyMasses = _sim.bodyMasses();
+
+    vector<float> particleSizes(bodyIds.size());
+    vector<vec3>  particleColors(bodyIds.size());
+    for (int ib = 0; ib < (int)bodyIds.size(); ++ib) {
+        particleSizes[ib]  = NBodySim::bodyRadius(std::max(bodyMasses[ib], TracerStarMass));
+        particleColors[ib] = _starColors[bodyIds[ib]];
     }
     _galaxyRenderer.updateParticleSizes(particleSizes);
     _galaxyRenderer.updateParticleColors(particleColors);
+    _starReorderCount = _sim.reorderCount();
+}
+
+void GalaxyScene::printThreadUse()
+{
+    const auto stats = _sim.threadPool().workerStats();
+
+    std::cout << "thread use:";
+    for (const auto& workerStats : stats) {
+        std::cout << " " << (int)std::round(100.0f * workerStats.utilization) << "%";
+    }
+    std::cout << std::endl;
+
+    _sim.threadPool().resetWorkerStats();
 }
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
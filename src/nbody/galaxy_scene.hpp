@@ -25,15 +25,37 @@ class DisplayWindow;
 
 class GalaxyScene : public Singleton<GalaxyScene>
 {
+    constexpr static const int SCENARIO_COUNT              = 3;
+    constexpr static const int MAX_EXACT_SOLVER_PAIR_COUNT = 8192 * 8192;
+    constexpr static const int FORCE_ERROR_SAMPLE_COUNT    = 64;
+    constexpr static const int FORCE_ERROR_REPORT_INTERVAL = 100;
+    constexpr static const int THREAD_REPORT_INTERVAL      = 100;
+    constexpr static const int HISTORY_REPORT_INTERVAL     = 100;
+    constexpr static const int POSITION_PACK_CHUNK_SIZE    = 4096;
+
+    constexpr static const float ESCAPE_RADIUS = 40.0f;  // Eight radii of the discs, beyond which the escaping stars get removed.
+
     DisplayWindow& _displayWindow;
     GalaxyRenderer _galaxyRenderer;
     NBodySim       _sim;
+    vector<vec3>   _framePositions;  // The positions drawn in the current frame, while the simulation advances to the next one.
+    vector<vec3>   _starColors;      // By body ID, as the simulation reorders the bodies.
+    int            _starReorderCount = 0;  // The order of the bodies the uploaded sizes and colors follow.
+    int            _scenarioId       = 0;
+    bool           _reportForceError = false;
+    bool           _reportThreadUse  = false;
 
 public:
     GalaxyScene(DisplayWindow& displayWindow);
     ~GalaxyScene();
 
     void spawnScenario(int scenarioId = 0);
+    void respawnScenario() { spawnScenario(_scenarioId); }
+    void cycleForceSolver();
+    void toggleForceErrorReport();
+    void toggleThreadUseReport();
+    void toggleMerging();
+    void toggleEscaperRemoval();
 
     void onTick(uint64_t tickCount, float dt);
     bool handleEvent(const SDL_Event& generalEvent);
@@ -41,7 +63,9 @@ public:
 private:
     void handleKeyboardEvent(const SDL_KeyboardEvent& keyboardEvent);
 
-    void regenerateStarSizesAndColors();
+    void regenerateStarColors();
+    void uploadStarSizesAndColors();
+    void printThreadUse();
 };
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
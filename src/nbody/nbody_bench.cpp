@@ -0,0 +1,1221 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "nbody/nbody_bench.hpp"
+
+#include "core/cache_miss_counter.hpp"
+#include "core/clock.hpp"
+#include "nbody/galaxy_generator.hpp"
+#include "nbody/nbody_sim.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+struct NBodyBenchArgs {
+    int bodyCount   = 4096;
+    int stepCount   = 64;
+    int threadCount = 0;  // All the hardware threads.
+};
+
+struct NBodyBench {
+    std::string_view name;
+    std::string_view description;
+    int (*run)(const NBodyBenchArgs& args);
+};
+
+constexpr float  BenchStepDt            = 0.005f;
+constexpr int    BenchErrorSampleCount  = 256;
+constexpr int    BenchWarmUpStepCount   = 200;
+constexpr int    BenchMaxExactBodyCount = 8192;  // The exact solver takes too long on the larger discs.
+constexpr double MiB                    = 1024.0 * 1024.0;
+
+static const NBodySim::ForceSolver allForceSolvers[] = {NBodySim::ForceSolver::Exact, NBodySim::ForceSolver::BarnesHut, NBodySim::ForceSolver::Fmm, NBodySim::ForceSolver::Newtonian,
+                                                       NBodySim::ForceSolver::Analytic};
+
+static const char* forceSolverName(NBodySim::ForceSolver forceSolver)
+{
+    switch (forceSolver) {
+        case NBodySim::ForceSolver::Exact:
+            return "exact";
+        case NBodySim::ForceSolver::BarnesHut:
+            return "barnes-hut";
+        case NBodySim::ForceSolver::Fmm:
+            return "fmm";
+        case NBodySim::ForceSolver::Newtonian:
+            return "newtonian";
+        case NBodySim::ForceSolver::Analytic:
+            return "analytic";
+    }
+    return "?";
+}
+
+static const char* exactSearchName(NBodySim::ExactSearch exactSearch)
+{
+    switch (exactSearch) {
+        case NBodySim::ExactSearch::Cached:
+            return "cached";
+        case NBodySim::ExactSearch::Coherent:
+            return "coherent";
+        case NBodySim::ExactSearch::Cacheless:
+            return "cacheless";
+    }
+    return "?";
+}
+
+static vector<NBodySim::Body> makeBenchBodies(int bodyCount)
+{
+    std::mt19937 re(0);
+    return generateDiscGalaxy(re, bodyCount);
+}
+
+// Spawns the benchmark disc and lets it evolve with the Barnes-Hut solver before switching to the solver under test. This skips
+// the transient after a respawn, while the first signals of the bodies have not crossed the disc yet and the approximate solvers
+// disagree with the exact one around the causal front.
+//
+static void spawnWarmedUp(NBodySim& sim, int threadCount, int bodyCount, NBodySim::ForceSolver forceSolver, float openingAngle = 0.5f)
+{
+    sim.setThreadCount(threadCount);
+    sim.respawn(makeBenchBodies(bodyCount), NBodySim::ForceSolver::BarnesHut);
+    for (int i = 0; i < BenchWarmUpStepCount; ++i) {
+        sim.step(BenchStepDt);
+    }
+
+    sim.setOpeningAngle(openingAngle);
+    sim.setForceSolver(forceSolver);
+}
+
+// Advances the simulation by `stepCount` steps and returns the average wall time of a step in milliseconds.
+//
+static double timeSteps(NBodySim& sim, int stepCount)
+{
+    const auto startTime = Clock::now();
+    for (int i = 0; i < stepCount; ++i) {
+        sim.step(BenchStepDt);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime);
+    return (double)elapsed.count() / 1e+3 / std::max(1, stepCount);
+}
+
+// Advances the simulation by one step in the comparison mode and returns the error of the accelerations computed in that step.
+//
+static NBodySim::ForceErrorStats measureStepForceError(NBodySim& sim)
+{
+    sim.setForceErrorSampleCount(BenchErrorSampleCount);
+    sim.step(BenchStepDt);
+    sim.setForceErrorSampleCount(0);
+    return sim.forceErrorStats();
+}
+
+// Returns the given values of the bodies, such as their accelerations, indexed by the IDs of the bodies. The runs compare their
+// bodies by the IDs, as they may get reordered differently.
+//
+static vector<vec3> byBodyId(const NBodySim& sim, std::span<const vec3> values)
+{
+    vector<vec3> valuesById(values.size());
+    for (int ib = 0; ib < (int)values.size(); ++ib) {
+        valuesById[sim.bodyIds()[ib]] = values[ib];
+    }
+    return valuesById;
+}
+
+struct AccelDeviation {
+    float rms = 0.0f;
+    float max = 0.0f;
+};
+
+// Returns the deviation of the accelerations from the reference ones, relative to the magnitude of each reference acceleration.
+//
+static AccelDeviation accelDeviation(std::span<const vec3> accels, std::span<const vec3> referenceAccels)
+{
+    double         sumRelDeviationSq = 0.0;
+    AccelDeviation deviation;
+    for (int i = 0; i < (int)accels.size(); ++i) {
+        const float relDeviation = glm::length(accels[i] - referenceAccels[i]) / std::max(glm::length(referenceAccels[i]), 1e-20f);
+        sumRelDeviationSq += (double)relDeviation * relDeviation;
+        deviation.max = std::max(deviation.max, relDeviation);
+    }
+    deviation.rms = (float)std::sqrt(sumRelDeviationSq / std::max(1, (int)accels.size()));
+    return deviation;
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// Compares the step time and the force error of all the solvers on the same system.
+//
+static int benchSolvers(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    for (auto forceSolver : allForceSolvers) {
+        if (forceSolver == NBodySim::ForceSolver::Exact && args.bodyCount > BenchMaxExactBodyCount) {
+            std::cout << forceSolverName(forceSolver) << ": skipped (too many bodies for the exact solver)" << std::endl;
+            continue;
+        }
+
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, forceSolver);
+        const double stepMs = timeSteps(sim, args.stepCount);
+        const auto   error  = measureStepForceError(sim);
+
+        std::cout << forceSolverName(forceSolver) << ": " << stepMs << " ms/step, force error rms " << error.rmsRelError << " max " << error.maxRelError << std::endl;
+    }
+    return 0;
+}
+
+// Sweeps the opening angle of the approximate solvers to expose their trade-off between speed and accuracy.
+//
+static int benchOpeningAngle(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    for (auto forceSolver : {NBodySim::ForceSolver::BarnesHut, NBodySim::ForceSolver::Fmm}) {
+        for (float openingAngle : {0.2f, 0.35f, 0.5f, 0.7f, 1.0f}) {
+            NBodySim sim;
+            spawnWarmedUp(sim, args.threadCount, args.bodyCount, forceSolver, openingAngle);
+            const double stepMs = timeSteps(sim, args.stepCount);
+            const auto   error  = measureStepForceError(sim);
+
+            std::cout << forceSolverName(forceSolver) << ", theta " << openingAngle << ": " << stepMs << " ms/step, force error rms " << error.rmsRelError << " max "
+                      << error.maxRelError << std::endl;
+        }
+    }
+    return 0;
+}
+
+// Shows how the step time of the approximate solvers grows with the number of bodies, up to `bodyCount`.
+//
+static int benchScaling(const NBodyBenchArgs& args)
+{
+    std::cout << "steps: " << args.stepCount << std::endl;
+
+    for (int bodyCount = std::max(2, args.bodyCount / 8); bodyCount <= args.bodyCount; bodyCount *= 2) {
+        for (auto forceSolver : {NBodySim::ForceSolver::BarnesHut, NBodySim::ForceSolver::Fmm}) {
+            NBodySim sim;
+            spawnWarmedUp(sim, args.threadCount, bodyCount, forceSolver);
+            const double stepMs = timeSteps(sim, args.stepCount);
+
+            std::cout << forceSolverName(forceSolver) << " @ " << bodyCount << " bodies: " << stepMs << " ms/step, " << 1e+3 * stepMs / bodyCount << " us/body" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// Compares the pair throughput of the vectorized kernels of the exact solver against the scalar reference. The accelerations
+// of the first step, computed from the same state by each kernel, must match those of the reference.
+//
+static int benchSimd(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << ", detected: " << simdIsaName(detectSimdIsa()) << std::endl;
+
+    const double pairsPerStep = (double)args.bodyCount * (args.bodyCount - 1);
+    vector<vec3> referenceAccels;
+    double       referenceStepMs = 0.0;
+    int          result          = 0;
+
+    for (auto simdIsa : {SimdIsa::Scalar, SimdIsa::Sse4, SimdIsa::Avx2, SimdIsa::Avx512}) {
+        if (simdIsa > detectSimdIsa()) {
+            std::cout << simdIsaName(simdIsa) << ": not supported" << std::endl;
+            continue;
+        }
+
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, NBodySim::ForceSolver::Exact);
+        sim.setSimdIsa(simdIsa);
+
+        // The first step also fills the light intersection cache, which is cold after switching the solver.
+        sim.step(BenchStepDt);
+        const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+        if (referenceAccels.empty()) {
+            referenceAccels = accels;
+        }
+        const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+        if (deviation.max != 0.0f) {
+            result = 1;
+        }
+
+        const double stepMs = timeSteps(sim, args.stepCount);
+        if (simdIsa == SimdIsa::Scalar) {
+            referenceStepMs = stepMs;
+        }
+
+        std::cout << simdIsaName(simdIsa) << ": " << stepMs << " ms/step, " << pairsPerStep / (stepMs * 1e+3) << " Mpairs/s, speedup " << referenceStepMs / stepMs
+                  << ", max deviation " << deviation.max << std::endl;
+    }
+    return result;
+}
+
+// Reports the footprint of the light intersection cache of the exact solver, and the memory traffic of reading and writing
+// it back in each step, against the unquantized entries of a record index and an alpha of 4 bytes each.
+// The force error includes the error of the hints, which are quantized between the steps.
+//
+static int benchCache(const NBodyBenchArgs& args)
+{
+    constexpr int UnquantizedSize    = sizeof(int) + sizeof(float);
+    constexpr int EntrySize          = sizeof(NBodySim::LightIntersectCacheEntry);
+    constexpr int ProjectedBodyCount = 100000;
+
+    std::cout << "steps: " << args.stepCount << ", entry: " << EntrySize << " bytes (" << UnquantizedSize << " unquantized)" << std::endl;
+
+    for (int bodyCount = std::max(256, args.bodyCount / 4); bodyCount <= args.bodyCount; bodyCount *= 2) {
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, bodyCount, NBodySim::ForceSolver::Exact);
+        const double stepMs = timeSteps(sim, args.stepCount);
+        const auto   error  = measureStepForceError(sim);
+
+        const double pairCount = (double)bodyCount * bodyCount;
+        const double cacheMiB  = pairCount * EntrySize / MiB;
+        std::cout << bodyCount << " bodies: cache " << cacheMiB << " MiB (" << pairCount * UnquantizedSize / MiB << " unquantized), traffic "
+                  << 2.0 * cacheMiB / (stepMs * 1e-3) << " MiB/s at " << stepMs << " ms/step, force error rms " << error.rmsRelError << " max " << error.maxRelError
+                  << std::endl;
+    }
+
+    const double projectedPairCount = (double)ProjectedBodyCount * ProjectedBodyCount;
+    std::cout << ProjectedBodyCount << " bodies: cache " << projectedPairCount * EntrySize / (1024.0 * MiB) << " GiB (" << projectedPairCount * UnquantizedSize / (1024.0 * MiB)
+              << " unquantized)" << std::endl;
+    return 0;
+}
+
+// Compares the compressed position history against the full one: its size, the step time of the exact solver, and the deviation
+// of the accelerations computed from the same state. Then follows the bodies with the Barnes-Hut solver for `stepCount` records,
+// keeping their true positions aside, and checks the recorded ones against them: the bench fails if they exceed the error bound.
+//
+static int benchHistory(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    vector<vec3> referenceAccels;
+    int          result = 0;
+    for (auto historyEncoding : {NBodySim::HistoryEncoding::Full, NBodySim::HistoryEncoding::Fixed16}) {
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, NBodySim::ForceSolver::Exact);
+        sim.setAdaptiveHistory(false);
+        sim.setHistoryEncoding(historyEncoding);
+
+        sim.step(BenchStepDt);
+        const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+        if (referenceAccels.empty()) {
+            referenceAccels = accels;
+        }
+        const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+
+        const double stepMs = timeSteps(sim, args.stepCount);
+
+        const int    bodyCount      = sim.bodyCount();
+        const int    firstRecordIdx = sim.newestRecordIdx() + 1;
+        vector<vec3> truePosArr((size_t)sim.historyRecordCount() * bodyCount);
+
+        sim.setForceSolver(NBodySim::ForceSolver::BarnesHut);
+        for (int step = 0; step < args.stepCount * sim.recordStepInterval(); ++step) {
+            sim.step(BenchStepDt);
+            const int slot = sim.newestRecordIdx() % sim.historyRecordCount();
+            for (int ib = 0; ib < bodyCount; ++ib) {
+                truePosArr[(size_t)slot * bodyCount + sim.bodyIds()[ib]] = sim.bodyPositions()[ib];
+            }
+        }
+
+        float maxError = 0.0f;
+        for (int ir = std::max(firstRecordIdx, sim.levelOldestRecordIdx(0)); ir <= sim.newestRecordIdx(); ++ir) {
+            const int slot = ir % sim.historyRecordCount();
+            for (int ib = 0; ib < bodyCount; ++ib) {
+                const vec3 error = glm::abs(sim.histPos(slot, ib) - truePosArr[(size_t)slot * bodyCount + sim.bodyIds()[ib]]);
+                maxError         = std::max({maxError, error.x, error.y, error.z});
+            }
+        }
+        const float errorBound = sim.historyErrorBound();
+        if (maxError > errorBound) {
+            result = 1;
+        }
+
+        std::cout << (historyEncoding == NBodySim::HistoryEncoding::Full ? "full" : "fixed16") << ": " << (double)sim.historyByteCount() / bodyCount << " bytes/body, "
+                  << stepMs << " ms/step, max deviation " << deviation.max << ", position error " << maxError << " (bound " << errorBound << ", "
+                  << (maxError <= errorBound ? "ok" : "exceeded") << ")" << std::endl;
+    }
+    return result;
+}
+
+// Spreads the benchmark disc wider than the light travels over the dense level of the history, and lets it evolve with the
+// Newtonian solver, which keeps no history. The states are thus the same for each level count, and the exact solver takes over
+// with the history extrapolated over all its levels, so that its accelerations differ only by the sources in view. They are
+// compared against those of the deepest history, next to its size and the step time.
+//
+static int benchHistoryLevels(const NBodyBenchArgs& args)
+{
+    constexpr int   MaxLevelCount = 3;
+    constexpr float DiscScale     = 10.0f;
+
+    // The velocities shrink with the square root of the radius, which keeps the orbits bound.
+    vector<NBodySim::Body> bodies = makeBenchBodies(args.bodyCount);
+    for (auto& body : bodies) {
+        body.pos *= DiscScale;
+        body.vel /= std::sqrt(DiscScale);
+    }
+
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << ", disc radius: " << 5.0f * DiscScale << std::endl;
+
+    vector<vec3> referenceAccels;
+    for (int levelCount = MaxLevelCount; levelCount >= 1; --levelCount) {
+        NBodySim sim;
+        sim.setThreadCount(args.threadCount);
+        sim.setHistoryLevelCount(levelCount);
+        sim.setAdaptiveHistory(false);
+        sim.respawn(bodies, NBodySim::ForceSolver::Newtonian);
+        for (int i = 0; i < BenchWarmUpStepCount; ++i) {
+            sim.step(BenchStepDt);
+        }
+
+        sim.setForceSolver(NBodySim::ForceSolver::Exact);
+
+        const auto  posArr  = sim.bodyPositions();
+        // The sources in view are those whose signal delay, as in `NBodySim::lightDelay`, fits in the look-back of the history.
+        const float horizon = std::sqrt(sim.historyLookBack() * sim.LightSpeedSq);
+        int64_t     inView  = 0;
+        for (int it = 0; it < sim.bodyCount(); ++it) {
+            for (int is = 0; is < sim.bodyCount(); ++is) {
+                inView += (is != it && glm::distance(posArr[it], posArr[is]) < horizon);
+            }
+        }
+
+        sim.step(BenchStepDt);
+        const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+
+        // Relative to the magnitude of all the reference accelerations, as the bodies with no source in view have none.
+        float rmsRelDeviation = 0.0f;
+        if (referenceAccels.empty()) {
+            referenceAccels = accels;
+        } else {
+            double sumDeviationSq = 0.0;
+            double sumAccelSq     = 0.0;
+            for (int ib = 0; ib < (int)accels.size(); ++ib) {
+                sumDeviationSq += glm::length2(accels[ib] - referenceAccels[ib]);
+                sumAccelSq += glm::length2(referenceAccels[ib]);
+            }
+            rmsRelDeviation = (float)std::sqrt(sumDeviationSq / std::max(sumAccelSq, 1e-40));
+        }
+
+        const double stepMs = timeSteps(sim, args.stepCount);
+
+        std::cout << levelCount << " levels: " << (double)sim.historyByteCount() / sim.bodyCount() << " bytes/body, horizon " << horizon << ", pairs in view "
+                  << 100.0 * inView / ((double)sim.bodyCount() * (sim.bodyCount() - 1)) << "%, " << stepMs << " ms/step, force deviation rms " << rmsRelDeviation
+                  << std::endl;
+    }
+    return 0;
+}
+
+// Lets discs of growing radius evolve with the Barnes-Hut solver, with the default fixed depth of the history and with the
+// adaptive one, then counts the pairs of bodies the exact solver finds out of the history. The fixed depth wastes memory on
+// the small discs, and drops sources on the wide ones.
+//
+static int benchHistoryDepth(const NBodyBenchArgs& args)
+{
+    constexpr float DiscScales[] = {1.0f, 4.0f, 16.0f};
+
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount * NBodySim::HistDepthCheckInterval << " records" << std::endl;
+
+    for (const float discScale : DiscScales) {
+        vector<NBodySim::Body> bodies = makeBenchBodies(args.bodyCount);
+        for (auto& body : bodies) {
+            body.pos *= discScale;
+            body.vel /= std::sqrt(discScale);
+        }
+
+        for (const bool adaptiveHistory : {false, true}) {
+            NBodySim sim;
+            sim.setThreadCount(args.threadCount);
+            sim.setAdaptiveHistory(adaptiveHistory);
+            sim.respawn(bodies, NBodySim::ForceSolver::BarnesHut);
+            const double stepMs = timeSteps(sim, args.stepCount * NBodySim::HistDepthCheckInterval * sim.recordStepInterval());
+
+            sim.setForceSolver(NBodySim::ForceSolver::Exact);
+            sim.step(BenchStepDt);
+
+            std::cout << "disc radius " << 5.0f * discScale << ", " << (adaptiveHistory ? "adaptive" : "fixed") << ": " << sim.historyRecordCount() << " records, "
+                      << (double)sim.historyByteCount() / sim.bodyCount() << " bytes/body, horizon " << std::sqrt(sim.historyLookBack() * sim.LightSpeedSq)
+                      << ", pairs out of history " << sim.outOfWindowCount() << ", " << stepMs << " ms/step" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// Measures the search of the light-cone crossings after `stepCount` steps: the segments it visits from the hints of the light
+// intersection cache of the exact solver, and from the cold hints of the Barnes-Hut solver, which keeps no cache for the pairs
+// of bodies. The crossings must match those of an exhaustive scan of the history, and are checked against the light-cone criterion.
+//
+static int benchSearch(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    int result = 0;
+    for (auto forceSolver : {NBodySim::ForceSolver::Exact, NBodySim::ForceSolver::BarnesHut}) {
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, forceSolver);
+        const double stepMs = timeSteps(sim, args.stepCount);
+
+        const auto stats = sim.measureRetardedSearch(BenchErrorSampleCount);
+        if (stats.mismatchFraction != 0.0f) {
+            result = 1;
+        }
+        std::cout << forceSolverName(forceSolver) << ": " << stepMs << " ms/step, " << stats.meanStepCount << " segments/search (max " << stats.maxStepCount
+                  << "), residual max " << stats.maxResidual << ", crossings off the newest one " << 100.0f * stats.mismatchFraction << "% (" << stats.sampleCount
+                  << " pairs)" << std::endl;
+    }
+    return result;
+}
+
+// Shows how the step time of the force solvers shrinks with the number of threads, up to `threadCount`, and how busy each thread is.
+// The accelerations of the first step, computed from the same state, must match those computed by a single thread.
+//
+static int benchThreads(const NBodyBenchArgs& args)
+{
+    const int maxThreadCount = (args.threadCount > 0) ? args.threadCount : ThreadPool::hardwareThreadCount();
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << ", hardware threads: " << ThreadPool::hardwareThreadCount() << std::endl;
+
+    int result = 0;
+    for (auto forceSolver : {NBodySim::ForceSolver::Exact, NBodySim::ForceSolver::BarnesHut}) {
+        vector<vec3> referenceAccels;
+        double       referenceStepMs = 0.0;
+
+        for (int threadCount = 1; threadCount <= maxThreadCount; threadCount = (threadCount < maxThreadCount) ? std::min(2 * threadCount, maxThreadCount) : threadCount + 1) {
+            NBodySim sim;
+            spawnWarmedUp(sim, threadCount, args.bodyCount, forceSolver);
+
+            sim.step(BenchStepDt);
+            const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+            if (referenceAccels.empty()) {
+                referenceAccels = accels;
+            }
+            const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+            if (deviation.max != 0.0f) {
+                result = 1;
+            }
+
+            sim.threadPool().resetWorkerStats();
+            const double stepMs = timeSteps(sim, args.stepCount);
+            if (threadCount == 1) {
+                referenceStepMs = stepMs;
+            }
+
+            std::cout << forceSolverName(forceSolver) << " @ " << threadCount << " threads: " << stepMs << " ms/step, speedup " << referenceStepMs / stepMs << ", max deviation " << deviation.max
+                      << ", thread use";
+            for (const auto& workerStats : sim.threadPool().workerStats()) {
+                std::cout << " " << (int)std::round(100.0f * workerStats.utilization) << "%";
+            }
+            std::cout << std::endl;
+        }
+    }
+    return result;
+}
+
+// Compares the first step of the exact solver after its light intersection cache has been reset, when every search starts from
+// a guess, against the following steps, which start from the cached crossings. The cache is reset once more after these steps.
+//
+static int benchColdCache(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    for (auto simdIsa : {SimdIsa::Scalar, detectSimdIsa()}) {
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, NBodySim::ForceSolver::Exact);
+        sim.setSimdIsa(simdIsa);
+
+        const auto   coldStats  = sim.measureRetardedSearch(BenchErrorSampleCount);
+        const double coldStepMs = timeSteps(sim, 1);
+
+        vector<double> warmStepMsArr(args.stepCount);
+        for (double& stepMs : warmStepMsArr) {
+            stepMs = timeSteps(sim, 1);
+        }
+        const double warmStepMs    = std::accumulate(warmStepMsArr.begin(), warmStepMsArr.end(), 0.0) / args.stepCount;
+        const double maxWarmStepMs = std::ranges::max(warmStepMsArr);
+        const auto   warmStats     = sim.measureRetardedSearch(BenchErrorSampleCount);
+
+        sim.setForceSolver(NBodySim::ForceSolver::BarnesHut);
+        sim.setForceSolver(NBodySim::ForceSolver::Exact);
+        const double resetStepMs = timeSteps(sim, 1);
+
+        std::cout << simdIsaName(simdIsa) << ": cold " << coldStepMs << " ms (" << coldStats.meanStepCount << " segments/search, max " << coldStats.maxStepCount << "), warm "
+                  << warmStepMs << " ms/step (max " << maxWarmStepMs << " ms, " << warmStats.meanStepCount << " segments/search, max " << warmStats.maxStepCount
+                  << "), after a reset " << resetStepMs << " ms, worst step " << std::max(coldStepMs, resetStepMs) / warmStepMs << "x the warm one" << std::endl;
+        if (simdIsa == detectSimdIsa()) {
+            break;
+        }
+    }
+    return 0;
+}
+
+// Times the first steps of the exact solver after a respawn, with and without skipping the pairs out of the causal horizon,
+// on the benchmark disc and on two discs far apart. Both runs must end with the same accelerations.
+//
+static int benchHorizon(const NBodyBenchArgs& args)
+{
+    constexpr float Separation = 200.0f;
+
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    vector<NBodySim::Body> pairBodies = makeBenchBodies(args.bodyCount / 2);
+    for (auto body : makeBenchBodies(args.bodyCount - args.bodyCount / 2)) {
+        body.pos.x += Separation;
+        pairBodies.push_back(body);
+    }
+
+    const std::pair<const char*, vector<NBodySim::Body>> scenes[] = {{"disc", makeBenchBodies(args.bodyCount)}, {"two discs", pairBodies}};
+    int                                                  result   = 0;
+    for (const auto& [sceneName, bodies] : scenes) {
+        const double pairsPerStep = (double)bodies.size() * (bodies.size() - 1);
+
+        vector<vec3> referenceAccels;
+        for (bool horizonSkipping : {false, true}) {
+            NBodySim sim;
+            sim.setThreadCount(args.threadCount);
+            sim.setHorizonSkipping(horizonSkipping);
+            sim.respawn(bodies, NBodySim::ForceSolver::Exact);
+
+            double     skipFraction = 0.0;
+            const auto startTime    = Clock::now();
+            for (int i = 0; i < args.stepCount; ++i) {
+                sim.step(BenchStepDt);
+                skipFraction += sim.horizonSkipCount() / pairsPerStep / args.stepCount;
+            }
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime);
+
+            const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+            if (referenceAccels.empty()) {
+                referenceAccels = accels;
+            }
+            const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+            if (deviation.max != 0.0f) {
+                result = 1;
+            }
+
+            std::cout << sceneName << (horizonSkipping ? ", skipping: " : ", searching all: ") << (double)elapsed.count() / 1e+3 / args.stepCount << " ms/step, "
+                      << 100.0 * skipFraction << "% pairs skipped with their tiles, max deviation " << deviation.max << std::endl;
+        }
+    }
+    return result;
+}
+
+// Compares the exact solver sweeping the sources in blocks shared by chunks of target tiles against sweeping all the sources
+// for each target tile, on discs of 4096 bodies and more, doubling up to `bodyCount`. The solver runs on the calling thread
+// alone, which the hardware counters follow, when the operating system lets them be read. Both runs must end with the same
+// accelerations.
+//
+static int benchTiling(const NBodyBenchArgs& args)
+{
+    CacheMissCounter missCounter;
+    std::cout << "steps: " << args.stepCount << ", cache miss counters: " << (missCounter.available() ? "available" : "n/a") << std::endl;
+
+    int result = 0;
+    for (int bodyCount = std::min(4096, args.bodyCount); bodyCount <= args.bodyCount; bodyCount *= 2) {
+        const double pairsPerStep = (double)bodyCount * (bodyCount - 1);
+
+        vector<vec3> referenceAccels;
+        for (bool sourceBlocking : {false, true}) {
+            NBodySim sim;
+            spawnWarmedUp(sim, 1, bodyCount, NBodySim::ForceSolver::Exact);
+            sim.setSourceBlocking(sourceBlocking);
+            sim.step(BenchStepDt);
+
+            missCounter.start();
+            const double stepMs = timeSteps(sim, args.stepCount);
+            const auto   misses = missCounter.stop();
+
+            const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+            if (referenceAccels.empty()) {
+                referenceAccels = accels;
+            }
+            const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+            if (deviation.max != 0.0f) {
+                result = 1;
+            }
+
+            std::cout << bodyCount << (sourceBlocking ? " bodies, blocked: " : " bodies, unblocked: ") << stepMs << " ms/step, " << pairsPerStep / (stepMs * 1e+3)
+                      << " Mpairs/s, ";
+            if (missCounter.available()) {
+                const double pairCount = pairsPerStep * args.stepCount;
+                std::cout << misses.l1dReadMisses / pairCount << " L1D misses/pair, " << misses.llcReadMisses / pairCount << " LLC misses/pair ("
+                          << 100.0 * misses.llcReadMisses / std::max<int64_t>(misses.llcReads, 1) << "% of the LLC reads), ";
+            }
+            std::cout << "max deviation " << deviation.max << std::endl;
+        }
+    }
+    return result;
+}
+
+// Compares the exact solver searching each pair from its cached crossing against the coherent search, where each tile of targets
+// shares the crossing of each source. The tiles of the disc are wedges of consecutive bodies. Both must find the crossings and the
+// forces of the exhaustive search of each pair. The state of the solver is its light intersection cache or the shared crossings,
+// along with the horizon flags of the tiles.
+//
+static int benchCoherent(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    const double pairsPerStep = (double)args.bodyCount * (args.bodyCount - 1);
+    int          result       = 0;
+
+    for (auto exactSearch : {NBodySim::ExactSearch::Cached, NBodySim::ExactSearch::Coherent}) {
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, NBodySim::ForceSolver::Exact);
+        sim.setExactSearch(exactSearch);
+        sim.step(BenchStepDt);
+
+        const double stepMs = timeSteps(sim, args.stepCount);
+        const auto   stats  = sim.measureRetardedSearch(BenchErrorSampleCount);
+        const auto   error  = measureStepForceError(sim);
+        if (stats.mismatchFraction != 0.0f || error.maxRelError != 0.0f) {
+            result = 1;
+        }
+
+        const double stateMiB = (double)sim.searchStateByteCount() / MiB;
+        std::cout << exactSearchName(exactSearch) << ": " << stepMs << " ms/step, " << pairsPerStep / (stepMs * 1e+3) << " Mpairs/s, " << stats.meanStepCount
+                  << " segments/search (max " << stats.maxStepCount << "), crossings off the newest one " << 100.0f * stats.mismatchFraction << "%, force error rms "
+                  << error.rmsRelError << " max " << error.maxRelError << ", state " << stateMiB << " MiB" << std::endl;
+    }
+    return result;
+}
+
+// Compares the step time of the solvers with the bodies in their spawned order, which runs around the disc, against their order
+// along the Morton curve, and times the reordering of the spawned order along with the light intersection cache.
+//
+static int benchReorder(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+
+    struct Config {
+        const char*           name;
+        NBodySim::ForceSolver forceSolver;
+        NBodySim::ExactSearch exactSearch;
+    };
+    const Config configs[] = {
+        {"exact", NBodySim::ForceSolver::Exact, NBodySim::ExactSearch::Cached},
+        {"exact coherent", NBodySim::ForceSolver::Exact, NBodySim::ExactSearch::Coherent},
+        {"barnes-hut", NBodySim::ForceSolver::BarnesHut, NBodySim::ExactSearch::Cached},
+    };
+
+    for (bool reorder : {false, true}) {
+        for (const auto& config : configs) {
+            if (config.forceSolver == NBodySim::ForceSolver::Exact && args.bodyCount > BenchMaxExactBodyCount) {
+                continue;
+            }
+
+            NBodySim sim;
+            if (!reorder) {
+                sim.setReorderInterval(0);
+            }
+            spawnWarmedUp(sim, args.threadCount, args.bodyCount, config.forceSolver);
+            sim.setExactSearch(config.exactSearch);
+            sim.step(BenchStepDt);
+
+            const double stepMs = timeSteps(sim, args.stepCount);
+            std::cout << (reorder ? "morton " : "spawned ") << config.name << ": " << stepMs << " ms/step";
+            if (config.forceSolver == NBodySim::ForceSolver::Exact) {
+                std::cout << ", " << sim.measureRetardedSearch(BenchErrorSampleCount).meanStepCount << " segments/search";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // The first reordering moves nearly every body, as the spawned order runs around the disc.
+    if (args.bodyCount <= BenchMaxExactBodyCount) {
+        NBodySim sim;
+        sim.setReorderInterval(0);
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, NBodySim::ForceSolver::Exact);
+        sim.step(BenchStepDt);
+
+        const double stepMs = timeSteps(sim, 1);
+        sim.setReorderInterval(1);
+        const double reorderStepMs = timeSteps(sim, 1);
+        std::cout << "reordering: " << reorderStepMs - stepMs << " ms (" << sim.reorderCount() << " done), with a step of " << stepMs << " ms" << std::endl;
+    }
+    return 0;
+}
+
+// Compares the Newtonian solver against the exact one from the same state: the pair throughput of its vectorized kernel against
+// the scalar loop, and how far the retarded accelerations of the first step and the positions after the timed steps deviate from
+// the Newtonian ones of the scalar loop. Then compares a Newtonian warm-up against the Barnes-Hut one, before the exact solver
+// takes over with the extrapolated history.
+//
+static int benchNewtonian(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << ", detected: " << simdIsaName(detectSimdIsa()) << std::endl;
+
+    struct Config {
+        NBodySim::ForceSolver forceSolver;
+        SimdIsa               simdIsa;
+    };
+    const Config configs[] = {
+        {NBodySim::ForceSolver::Newtonian, SimdIsa::Scalar},
+        {NBodySim::ForceSolver::Newtonian, detectSimdIsa()},
+        {NBodySim::ForceSolver::Exact, detectSimdIsa()},
+    };
+
+    const double pairsPerStep = (double)args.bodyCount * (args.bodyCount - 1);
+    vector<vec3> referenceAccels;
+    vector<vec3> referencePositions;
+    double       referenceStepMs = 0.0;
+
+    for (const auto& config : configs) {
+        if (config.forceSolver == NBodySim::ForceSolver::Exact && args.bodyCount > BenchMaxExactBodyCount) {
+            std::cout << forceSolverName(config.forceSolver) << ": skipped (too many bodies for the exact solver)" << std::endl;
+            continue;
+        }
+
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, config.forceSolver);
+        sim.setSimdIsa(config.simdIsa);
+
+        sim.step(BenchStepDt);
+        const vector<vec3> accels    = byBodyId(sim, sim.bodyAccelerations());
+        const double       stepMs    = timeSteps(sim, args.stepCount);
+        const vector<vec3> positions = byBodyId(sim, sim.bodyPositions());
+
+        if (referenceAccels.empty()) {
+            referenceAccels    = accels;
+            referencePositions = positions;
+            referenceStepMs    = stepMs;
+        }
+
+        const AccelDeviation deviation  = accelDeviation(accels, referenceAccels);
+        double               sumDriftSq = 0.0;
+        for (int id = 0; id < (int)positions.size(); ++id) {
+            sumDriftSq += glm::distance2(positions[id], referencePositions[id]);
+        }
+
+        std::cout << forceSolverName(config.forceSolver) << " " << simdIsaName(config.simdIsa) << ": " << stepMs << " ms/step, " << pairsPerStep / (stepMs * 1e+3) << " Mpairs/s, speedup "
+                  << referenceStepMs / stepMs << ", accel deviation rms " << deviation.rms << " max " << deviation.max << ", drift rms " << std::sqrt(sumDriftSq / args.bodyCount) << std::endl;
+    }
+
+    if (args.bodyCount <= BenchMaxExactBodyCount) {
+        for (auto warmUpSolver : {NBodySim::ForceSolver::BarnesHut, NBodySim::ForceSolver::Newtonian}) {
+            NBodySim sim;
+            sim.setThreadCount(args.threadCount);
+            sim.respawn(makeBenchBodies(args.bodyCount), warmUpSolver);
+            const double warmUpMs = timeSteps(sim, BenchWarmUpStepCount);
+
+            sim.setForceSolver(NBodySim::ForceSolver::Exact);
+            const double stepMs = timeSteps(sim, args.stepCount);
+            std::cout << forceSolverName(warmUpSolver) << " warm-up: " << warmUpMs << " ms/step, then exact: " << stepMs << " ms/step, horizon "
+                      << std::sqrt(sim.historyLookBack() * sim.LightSpeedSq) << ", " << sim.outOfWindowTotal() << " pairs out of the history" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// Compares the analytic solver against the exact one from the same state, versus the tolerance of its error estimate: the step
+// time, the share of the pairs falling back to the search of the history, and the deviation of the accelerations of the first
+// step from those of the exact solver. Without the fallback, the solver keeps no history.
+//
+static int benchAnalytic(const NBodyBenchArgs& args)
+{
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+    if (args.bodyCount > BenchMaxExactBodyCount) {
+        std::cout << "skipped (too many bodies for the exact solver)" << std::endl;
+        return 0;
+    }
+
+    struct Config {
+        NBodySim::ForceSolver forceSolver;
+        bool                  fallback;
+        float                 errorTolerance;
+    };
+    const Config configs[] = {
+        {NBodySim::ForceSolver::Exact, true, 0.0f},
+        {NBodySim::ForceSolver::Analytic, true, 1e-2f},
+        {NBodySim::ForceSolver::Analytic, true, 1e-3f},
+        {NBodySim::ForceSolver::Analytic, true, 1e-4f},
+        {NBodySim::ForceSolver::Analytic, false, 0.0f},
+    };
+
+    const double pairsPerStep = (double)args.bodyCount * (args.bodyCount - 1);
+    vector<vec3> referenceAccels;
+
+    for (const auto& config : configs) {
+        NBodySim sim;
+        spawnWarmedUp(sim, args.threadCount, args.bodyCount, config.forceSolver);
+        sim.setAnalyticFallback(config.fallback);
+        sim.setAnalyticErrorTolerance(config.errorTolerance);
+
+        sim.step(BenchStepDt);
+        const vector<vec3> accels        = byBodyId(sim, sim.bodyAccelerations());
+        const double       fallbackShare = (double)sim.analyticFallbackCount() / pairsPerStep;
+        const double       stepMs        = timeSteps(sim, args.stepCount);
+
+        if (referenceAccels.empty()) {
+            referenceAccels = accels;
+        }
+
+        const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+
+        std::cout << forceSolverName(config.forceSolver);
+        if (config.forceSolver == NBodySim::ForceSolver::Analytic) {
+            std::cout << (config.fallback ? " tolerance " + std::to_string(config.errorTolerance) : std::string(" without fallback"));
+        }
+        std::cout << ": " << stepMs << " ms/step, fallback " << 100.0 * fallbackShare << "% of the pairs, deviation rms " << deviation.rms << " max " << deviation.max << ", history "
+                  << (double)sim.historyByteCount() / sim.bodyCount() << " bytes/body" << std::endl;
+    }
+    return 0;
+}
+
+// Compares the cacheless search of the exact solver against the cached one on discs of growing size, from an eighth of the
+// given number of bodies up to twice of it: the step time, the segments visited per search and the state kept for the searches.
+// The cached search reads and writes back its entry for each pair, so it slows down once the cache falls out of the last level
+// cache of the CPU, while the cacheless one only walks a few more segments from its guesses. The crossover is the smallest disc
+// where the cacheless search takes the lead. Both runs of each disc must end with the same accelerations.
+//
+static int benchCacheless(const NBodyBenchArgs& args)
+{
+    std::cout << "steps: " << args.stepCount << std::endl;
+
+    int crossoverBodyCount = 0;
+    int result             = 0;
+    for (int bodyCount = std::max(256, args.bodyCount / 8); bodyCount <= 2 * args.bodyCount; bodyCount *= 2) {
+        const double pairsPerStep = (double)bodyCount * (bodyCount - 1);
+
+        double       stepMsArr[2] = {};
+        vector<vec3> referenceAccels;
+        for (auto exactSearch : {NBodySim::ExactSearch::Cached, NBodySim::ExactSearch::Cacheless}) {
+            NBodySim sim;
+            spawnWarmedUp(sim, args.threadCount, bodyCount, NBodySim::ForceSolver::Exact);
+            sim.setExactSearch(exactSearch);
+            sim.step(BenchStepDt);
+
+            const double stepMs = timeSteps(sim, args.stepCount);
+            const auto   stats  = sim.measureRetardedSearch(BenchErrorSampleCount);
+
+            // Both runs start from the same state and must stay on the same crossings.
+            const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+            if (referenceAccels.empty()) {
+                referenceAccels = accels;
+            }
+            const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+            if (deviation.max != 0.0f) {
+                result = 1;
+            }
+            stepMsArr[exactSearch == NBodySim::ExactSearch::Cacheless] = stepMs;
+
+            std::cout << bodyCount << " bodies, " << exactSearchName(exactSearch) << ": " << stepMs << " ms/step, " << pairsPerStep / (stepMs * 1e+3) << " Mpairs/s, " << stats.meanStepCount
+                      << " segments/search, state " << (double)sim.searchStateByteCount() / MiB << " MiB, history " << (double)sim.historyByteCount() / MiB << " MiB, max deviation " << deviation.max
+                      << std::endl;
+        }
+
+        if (crossoverBodyCount == 0 && stepMsArr[1] < stepMsArr[0]) {
+            crossoverBodyCount = bodyCount;
+        }
+    }
+
+    if (crossoverBodyCount > 0) {
+        std::cout << "crossover: the cacheless search is faster from " << crossoverBodyCount << " bodies" << std::endl;
+    } else {
+        std::cout << "crossover: the cached search is faster up to " << 2 * args.bodyCount << " bodies" << std::endl;
+    }
+    return result;
+}
+
+// Sweeps the interval between the records of the history, with the linear interpolation of the world lines and with the Hermite
+// one. Each run warms the disc up with the Newtonian solver, which keeps no history, so all of them reach the same state; the
+// exact solver then takes over with the extrapolated history and runs as many steps as the warm-up, so that the signals of the
+// recorded positions cross the disc. The accelerations of the next step are compared against those of the linear interpolation
+// of a record per step. They include the drift of the bodies over the exact steps, caused by the deviations of the forces.
+// The history is shown per unit of its look-back, as its depth follows the delay of the signals across the system.
+//
+static int benchHermite(const NBodyBenchArgs& args)
+{
+    constexpr int RecordStepIntervals[] = {1, 4, 8, 16, 32, 64, 128};
+
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+    if (args.bodyCount > BenchMaxExactBodyCount) {
+        std::cout << "skipped (too many bodies for the exact solver)" << std::endl;
+        return 0;
+    }
+
+    vector<vec3> referenceAccels;
+    for (const int recordStepInterval : RecordStepIntervals) {
+        for (const bool hermiteHistory : {false, true}) {
+            NBodySim sim;
+            sim.setThreadCount(args.threadCount);
+            sim.setAdaptiveHistory(false);
+            sim.setRecordStepInterval(recordStepInterval);
+            sim.setHermiteHistory(hermiteHistory);
+            sim.respawn(makeBenchBodies(args.bodyCount), NBodySim::ForceSolver::Newtonian);
+            for (int i = 0; i < BenchWarmUpStepCount; ++i) {
+                sim.step(BenchStepDt);
+            }
+            sim.setForceSolver(NBodySim::ForceSolver::Exact);
+            for (int i = 0; i < BenchWarmUpStepCount; ++i) {
+                sim.step(BenchStepDt);
+            }
+
+            sim.step(BenchStepDt);
+            const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+            const double       stepMs = timeSteps(sim, args.stepCount);
+
+            if (referenceAccels.empty()) {
+                referenceAccels = accels;
+            }
+
+            const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+
+            std::cout << "interval " << recordStepInterval << ", " << (hermiteHistory ? "hermite" : "linear") << ": " << stepMs << " ms/step, deviation rms " << deviation.rms << " max "
+                      << deviation.max << ", history " << (double)sim.historyByteCount() / sim.bodyCount() / sim.historyLookBack() << " bytes/body per unit of look-back" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// Warms the disc up as the Hermite benchmark does, then compares the accelerations of the exact solver with the history of each
+// body sampled from a level of its own, by the tolerance of the interpolation error, against those of the history sampled at
+// the full rate. The bodies on the slow outer orbits are sampled sparsely, the ones near the centre densely.
+//
+static int benchSampling(const NBodyBenchArgs& args)
+{
+    constexpr int   SamplingLevelCount         = 4;
+    constexpr int   SamplingRecordStepInterval = 4;
+    constexpr float SamplingTolerances[]       = {0.0f, 1e-3f, 1e-2f, 1e-1f};
+
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+    if (args.bodyCount > BenchMaxExactBodyCount) {
+        std::cout << "skipped (too many bodies for the exact solver)" << std::endl;
+        return 0;
+    }
+
+    vector<vec3> referenceAccels;
+    for (const float samplingTolerance : SamplingTolerances) {
+        NBodySim sim;
+        sim.setThreadCount(args.threadCount);
+        sim.setAdaptiveHistory(false);
+        sim.setHistoryLevelCount(SamplingLevelCount);
+        sim.setRecordStepInterval(SamplingRecordStepInterval);
+        sim.setAdaptiveSampling(samplingTolerance > 0.0f);
+        sim.setSamplingTolerance(samplingTolerance);
+        sim.respawn(makeBenchBodies(args.bodyCount), NBodySim::ForceSolver::Newtonian);
+        for (int i = 0; i < BenchWarmUpStepCount; ++i) {
+            sim.step(BenchStepDt);
+        }
+        sim.setForceSolver(NBodySim::ForceSolver::Exact);
+        for (int i = 0; i < BenchWarmUpStepCount; ++i) {
+            sim.step(BenchStepDt);
+        }
+
+        sim.step(BenchStepDt);
+        const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+        const double       stepMs = timeSteps(sim, args.stepCount);
+
+        if (referenceAccels.empty()) {
+            referenceAccels = accels;
+        }
+
+        const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+
+        vector<int> firstLevelCounts(sim.historyLevelCount(), 0);
+        for (int ib = 0; ib < sim.sourceCount(); ++ib) {
+            ++firstLevelCounts[sim.histFirstLevel(ib)];
+        }
+
+        std::cout << (samplingTolerance > 0.0f ? "tolerance " + std::to_string(samplingTolerance) : std::string("full rate")) << ": " << stepMs << " ms/step, deviation rms " << deviation.rms
+                  << " max " << deviation.max << ", history " << (double)sim.historyByteCount() / sim.bodyCount() << " bytes/body, bodies per first level";
+        for (const int count : firstLevelCounts) {
+            std::cout << " " << count;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+// Sweeps the mass below which the bodies are tracers, which only feel the sources. Each run warms the disc up with the Newtonian
+// solver and all the bodies as sources, so all of them reach the same state; the exact solver then takes over with the history
+// of the sources extrapolated. The accelerations of its first step are compared against those with all the bodies as sources:
+// the deviation is the pull of the tracers which gets lost.
+//
+static int benchTracers(const NBodyBenchArgs& args)
+{
+    constexpr float TracerThresholds[] = {0.0f, 1e-3f, 3e-3f, 1e-2f};
+
+    std::cout << "bodies: " << args.bodyCount << ", steps: " << args.stepCount << std::endl;
+    if (args.bodyCount > BenchMaxExactBodyCount) {
+        std::cout << "skipped (too many bodies for the exact solver)" << std::endl;
+        return 0;
+    }
+
+    vector<vec3> referenceAccels;
+    double       referenceStepMs = 0.0;
+    for (const float tracerThreshold : TracerThresholds) {
+        NBodySim sim;
+        sim.setThreadCount(args.threadCount);
+        sim.respawn(makeBenchBodies(args.bodyCount), NBodySim::ForceSolver::Newtonian);
+        for (int i = 0; i < BenchWarmUpStepCount; ++i) {
+            sim.step(BenchStepDt);
+        }
+        sim.setTracerMassThreshold(tracerThreshold);
+        sim.setForceSolver(NBodySim::ForceSolver::Exact);
+
+        sim.step(BenchStepDt);
+        const vector<vec3> accels = byBodyId(sim, sim.bodyAccelerations());
+        const double       stepMs = timeSteps(sim, args.stepCount);
+
+        if (referenceAccels.empty()) {
+            referenceAccels = accels;
+            referenceStepMs = stepMs;
+        }
+
+        const AccelDeviation deviation = accelDeviation(accels, referenceAccels);
+
+        double tracerMass = 0.0;
+        double totalMass  = 0.0;
+        for (int ib = 0; ib < sim.bodyCount(); ++ib) {
+            tracerMass += (ib >= sim.sourceCount()) ? sim.bodyMasses()[ib] : 0.0f;
+            totalMass += sim.bodyMasses()[ib];
+        }
+
+        std::cout << "threshold " << tracerThreshold << ": " << sim.sourceCount() << " sources, tracer mass " << 100.0 * tracerMass / totalMass << "%, " << stepMs << " ms/step, speedup "
+                  << referenceStepMs / stepMs << ", deviation rms " << deviation.rms << " max " << deviation.max << ", state " << (double)sim.searchStateByteCount() / MiB << " MiB, history "
+                  << (double)sim.historyByteCount() / MiB << " MiB" << std::endl;
+    }
+    return 0;
+}
+
+// Runs two discs falling into each other with the Barnes-Hut solver, with and without the merging of the bodies which touch, in
+// phases of `stepCount` steps: the merged bodies drop out, so the steps get cheaper as the run goes on.
+//
+static int benchMerging(const NBodyBenchArgs& args)
+{
+    constexpr int   PhaseCount    = 4;
+    constexpr float Separation    = 12.0f;
+    constexpr float ApproachSpeed = 1.0f;
+
+    std::cout << "bodies: " << args.bodyCount << ", steps per phase: " << args.stepCount << std::endl;
+
+    vector<NBodySim::Body> bodies = makeBenchBodies(args.bodyCount / 2);
+    for (auto body : makeBenchBodies(args.bodyCount - args.bodyCount / 2)) {
+        body.pos.x += Separation;
+        body.vel.x -= ApproachSpeed;
+        bodies.push_back(body);
+    }
+
+    for (bool mergeOnContact : {false, true}) {
+        NBodySim sim;
+        sim.setThreadCount(args.threadCount);
+        sim.setMergeOnContact(mergeOnContact);
+        sim.respawn(bodies, NBodySim::ForceSolver::BarnesHut);
+
+        std::cout << (mergeOnContact ? "merging:" : "not merging:");
+        for (int phase = 0; phase < PhaseCount; ++phase) {
+            const double stepMs = timeSteps(sim, args.stepCount);
+            std::cout << " " << stepMs << " ms/step, then " << sim.bodyCount() << " bodies" << (phase + 1 < PhaseCount ? ";" : "");
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+// Runs a disc which flings every fourth body outward faster than it escapes, with the exact solver, with and without the removal
+// of the escapers, in phases of `stepCount` steps: the removal keeps both the bodies and the depth of the history from growing.
+//
+static int benchEscapers(const NBodyBenchArgs& args)
+{
+    constexpr int   PhaseCount   = 4;
+    constexpr float LaunchSpeed  = 6.0f;
+    constexpr float EscapeRadius = 10.0f;
+
+    std::cout << "bodies: " << args.bodyCount << ", steps per phase: " << args.stepCount << std::endl;
+    if (args.bodyCount > BenchMaxExactBodyCount) {
+        std::cout << "skipped (too many bodies for the exact solver)" << std::endl;
+        return 0;
+    }
+
+    vector<NBodySim::Body> bodies = makeBenchBodies(args.bodyCount);
+    for (int ib = 4; ib < (int)bodies.size(); ib += 4) {
+        bodies[ib].vel += LaunchSpeed * glm::normalize(bodies[ib].pos);
+    }
+
+    for (const float escapeRadius : {0.0f, EscapeRadius}) {
+        NBodySim sim;
+        sim.setThreadCount(args.threadCount);
+        sim.setEscapeRadius(escapeRadius);
+        sim.setKeepEscapedMass(true);
+        sim.respawn(bodies, NBodySim::ForceSolver::Exact);
+
+        std::cout << (escapeRadius > 0.0f ? "removing escapers:" : "keeping escapers:");
+        for (int phase = 0; phase < PhaseCount; ++phase) {
+            const double stepMs = timeSteps(sim, args.stepCount);
+            std::cout << " " << stepMs << " ms/step, then " << sim.bodyCount() << " bodies, " << sim.historyRecordCount() << " records, "
+                      << (double)sim.historyByteCount() / MiB << " MiB" << (phase + 1 < PhaseCount ? ";" : "");
+        }
+        std::cout << std::endl << "escaped " << sim.escapeCount() << " bodies, sources of mass " << sim.escapedMass() << std::endl;
+    }
+    return 0;
+}
+
+static const NBodyBench allBenches[] = {
+    {"solvers", "step time and force error of each force solver", &benchSolvers},
+    {"opening-angle", "step time and force error of the approximate solvers versus the opening angle", &benchOpeningAngle},
+    {"scaling", "step time of the approximate solvers versus the number of bodies", &benchScaling},
+    {"simd", "pair throughput of the vectorized kernels of the exact solver versus the scalar reference", &benchSimd},
+    {"threads", "step time of the force solvers versus the number of threads", &benchThreads},
+    {"cache", "memory and bandwidth of the light intersection cache of the exact solver", &benchCache},
+    {"history", "size, speed and error of the compressed position history", &benchHistory},
+    {"history-levels", "size, speed and reach of the multi-level position history on a disc wider than its dense level", &benchHistoryLevels},
+    {"search", "segments visited and accuracy of the search of the light-cone crossings, from cached and cold hints", &benchSearch},
+    {"history-depth", "depth, size and reach of the adaptive position history versus the fixed one on discs of growing radius", &benchHistoryDepth},
+    {"cold-cache", "step time of the exact solver right after its light intersection cache is reset, versus the warm steps", &benchColdCache},
+    {"horizon", "step time of the exact solver after a respawn, with and without skipping the pairs out of the causal horizon", &benchHorizon},
+    {"tiling", "step time and cache misses of the exact solver with and without sweeping the sources in blocks, versus the number of bodies", &benchTiling},
+    {"coherent", "step time and search cost of the exact solver with the crossings shared by the tiles of targets, versus the cached ones", &benchCoherent},
+    {"reorder", "step time of the solvers with the bodies in their spawned order versus along the Morton curve, and the cost of the reordering", &benchReorder},
+    {"newtonian", "step time of the Newtonian solver versus the exact one, the deviation of the retarded forces, and the Newtonian warm-up", &benchNewtonian},
+    {"analytic", "step time, fallback share and deviation of the analytic solver versus the exact one, by the tolerance of its error estimate", &benchAnalytic},
+    {"cacheless", "step time, search cost and memory of the exact solver without the light intersection cache versus with it, and their crossover", &benchCacheless},
+    {"hermite", "force deviation, step time and history size of the exact solver versus the record interval, with the linear and the Hermite interpolation", &benchHermite},
+    {"sampling", "force deviation, step time and history size of the exact solver with the history of each body sampled from a level of its own, by the tolerance", &benchSampling},
+    {"tracers", "step time, force deviation and memory of the exact solver with the bodies below a mass threshold as tracers, which attract nothing", &benchTracers},
+    {"merging", "step time and body count of two colliding discs over a long run, with and without merging the bodies which touch", &benchMerging},
+    {"escapers", "step time, body count and history depth of a disc flinging bodies away, with and without removing the escapers", &benchEscapers},
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+int runNBodyBench(std::span<char*> args)
+{
+    const auto printUsage = [] {
+        std::cerr << "usage: isamerion --bench <name> [bodyCount] [stepCount] [threadCount]" << std::endl;
+        for (const auto& bench : allBenches) {
+            std::cerr << "    " << bench.name << ": " << bench.description << std::endl;
+        }
+    };
+
+    if (args.empty()) {
+        printUsage();
+        return -1;
+    }
+
+    NBodyBenchArgs benchArgs{};
+    if (args.size() > 1) {
+        benchArgs.bodyCount = std::max(2, std::atoi(args[1]));
+    }
+    if (args.size() > 2) {
+        benchArgs.stepCount = std::max(1, std::atoi(args[2]));
+    }
+    if (args.size() > 3) {
+        benchArgs.threadCount = std::max(0, std::atoi(args[3]));
+    }
+
+    for (const auto& bench : allBenches) {
+        if (bench.name == args[0]) {
+            return bench.run(benchArgs);
+        }
+    }
+
+    printUsage();
+    return -1;
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -15,184 +15,2355 @@
 
 #include "nbody/nbody_sim.hpp"
 
+#include "nbody/retarded_fmm.hpp"
+#include "nbody/retarded_gravity_kernel.hpp"
+#include "nbody/retarded_octree.hpp"
+
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
 
-void NBodySim::respawn(vector<Body>&& bodies)
-{
-    _step      = 0;
-    _recordIdx = 0;
-    _time      = 0.0f;
-    _histTimeArr.resize(MaxRecordCount);
-    _histTimeArr[0] = _time;
+NBodySim::NBodySim() { setThreadCount(0); }
+
+NBodySim::~NBodySim() {}
+
+void NBodySim::respawn(std::span<const Body> bodies, std::optional<ForceSolver> forceSolver)
+{
+    _step             = 0;
+    _recordIdx        = 0;
+    _time             = 0.0f;
+    _outOfWindowCount = 0;
+    _outOfWindowTotal = 0;
+    _mergeCount       = 0;
+    _escapeCount      = 0;
+    _escapedMass      = 0.0f;
+    _escapedArr.clear();
+
+    _bodies.assign(bodies);
+    _bodyIdArr.resize(_bodies.size());
+    std::iota(_bodyIdArr.begin(), _bodyIdArr.end(), 0);
+
+    // The spawned order gets replaced right away, before there is any state to follow the bodies. The sources go first.
+    if (_reorderInterval > 0) {
+        _bodyIdArr = spatialOrder();
+    } else {
+        std::ranges::stable_partition(_bodyIdArr, [&](int ib) { return !isTracerMass(_bodies.field<&Body::mass>()[ib]); });
+    }
+    _bodies.permute(_bodyIdArr);
+    _sourceCount = (int)std::ranges::count_if(_bodies.field<&Body::mass>(), [&](float mass) { return !isTracerMass(mass); });
+    _bodyIdxArr.resize(_bodies.size());
+    for (int ib = 0; ib < _bodies.size(); ++ib) {
+        _bodyIdxArr[_bodyIdArr[ib]] = ib;
+    }
+    _reorderRecordIdx = 0;
+    _reorderCount     = 0;
+
+    if (forceSolver) {
+        _forceSolver = *forceSolver;
+    }
+    resetHistory();
+    resetSolverState();
+}
+
+// The bodies keep their order among the sources and among the tracers. The history of the sources starts anew, as the new ones
+// have none, and the state of the solvers follows the new split.
+//
+void NBodySim::setTracerMassThreshold(float tracerMassThreshold)
+{
+    if (tracerMassThreshold == _tracerMassThreshold) {
+        return;
+    }
+
+    _tracerMassThreshold = tracerMassThreshold;
+    if (_bodies.size() == 0) {
+        return;
+    }
+
+    const auto  body_mass_arr = _bodies.field<&Body::mass>();
+    const int   sourceCount   = (int)std::ranges::count_if(body_mass_arr, [&](float mass) { return !isTracerMass(mass); });
+    vector<int> order(_bodies.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_partition(order, [&](int ib) { return !isTracerMass(body_mass_arr[ib]); });
+    if (sourceCount == _sourceCount && std::ranges::is_sorted(order)) {
+        return;
+    }
+
+    permuteBodies(order);
+    _sourceCount = sourceCount;
+    if (keepsHistory()) {
+        extrapolateHistory();
+    }
+    resetSolverState();
+}
+
+void NBodySim::setKeepEscapedMass(bool keepEscapedMass)
+{
+    _keepEscapedMass = keepEscapedMass;
+    if (!keepEscapedMass) {
+        _escapedArr.clear();
+    }
+}
+
+void NBodySim::setHistoryEncoding(HistoryEncoding historyEncoding)
+{
+    if (historyEncoding == _historyEncoding) {
+        return;
+    }
+    if (!keepsHistory()) {
+        _historyEncoding = historyEncoding;
+        return;
+    }
+
+    const int sourceCount = _sourceCount;
+    const int rec_start   = oldestRecordIdx();
+    const int slotCount   = _histLevelCount * _recordCount;
+
+    // With the adaptive sampling, the newest record stays staged in either encoding.
+    if (historyEncoding == HistoryEncoding::Fixed16) {
+        commitStagedRecord();
+        _histPackedMat.reset(slotCount, histRowStarts(true), PackedHistPos{});
+        _histAnchorArr.assign(sourceCount, HistAnchor{ivec3{0}, HistMinScale, 0.5f * HistMinScale});
+
+        _threadPool->parallelFor(sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+            for (int ib = begin; ib < end; ++ib) {
+                // The records not converted yet lie at the origin of the grid, which thus starts at the oldest record.
+                const int  first_level = histFirstLevel(ib);
+                const vec3 oldest_grid = glm::round(histPos(histRecordSlot(rec_start, first_level), ib) / HistMinScale);
+                if (glm::all(glm::lessThan(glm::abs(oldest_grid), vec3(1 << 24)))) {
+                    _histAnchorArr[ib].originCode = ivec3(oldest_grid);
+                }
+                for (int ir = rec_start; ir <= _recordIdx; ++ir) {
+                    const int level = histRecordLevel(ir, _histLevelCount, first_level);
+                    if (ir % (1 << level) == 0) {
+                        recordPackedPos(ir, ib, histPos(histLevelSlot(level, ir), ib));
+                    }
+                }
+            }
+        });
+        _histPosMat = RaggedMatrix<vec3>{};
+        if (!_adaptiveSampling) {
+            _histStagePosArr.clear();
+        }
+
+    } else {
+        RaggedMatrix<vec3> posMat(slotCount, histRowStarts(false), vec3{});
+        _threadPool->parallelFor(sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+            for (int ib = begin; ib < end; ++ib) {
+                forEachHistSlot([&](int slot, int) { posMat({slot, ib}) = histPos(slot, ib); }, histFirstLevel(ib));
+            }
+        });
+        if (_histStagePosArr.empty()) {
+            _histStagePosArr.resize(sourceCount);
+            for (int ib = 0; ib < sourceCount; ++ib) {
+                _histStagePosArr[ib] = posMat({histLevelSlot(0, _recordIdx), ib});
+            }
+            _histStageRecordIdx = _recordIdx;
+        }
+        _histPosMat    = std::move(posMat);
+        _histPackedMat = RaggedMatrix<PackedHistPos>{};
+        _histAnchorArr.clear();
+    }
+
+    _historyEncoding = historyEncoding;
+}
+
+float NBodySim::historyErrorBound() const
+{
+    float errorBound = 0.0f;
+    for (const auto& anchor : _histAnchorArr) {
+        errorBound = std::max(errorBound, anchor.errorBound);
+    }
+    return errorBound;
+}
+
+size_t NBodySim::historyByteCount() const
+{
+    const size_t velByteCount   = sizeof(vec3) * _histVelMat.elementCount() + sizeof(vec3) * _histStageVelArr.size();
+    const size_t stageByteCount = sizeof(vec3) * _histStagePosArr.size() + sizeof(int) * _histFirstLevelArr.size();
+    if (_historyEncoding == HistoryEncoding::Fixed16) {
+        return sizeof(PackedHistPos) * _histPackedMat.elementCount() + sizeof(HistAnchor) * _histAnchorArr.size() + stageByteCount + velByteCount;
+    }
+    return sizeof(vec3) * _histPosMat.elementCount() + stageByteCount + velByteCount;
+}
+
+size_t NBodySim::searchStateByteCount() const
+{
+    return sizeof(LightIntersectCacheEntry) * _histInterMat.size().x * _histInterMat.size().y + sizeof(TileCrossing) * _tileCrossingMat.size().x * _tileCrossingMat.size().y
+         + (size_t)_horizonSkipMat.size().x * _horizonSkipMat.size().y + sizeof(TileReach) * _tileReachArr.size() + sizeof(int) * _recordGuessArr.size();
+}
+
+vec3 NBodySim::histPos(int slot, int body_idx) const
+{
+    return interpolateHistSlot(slot, body_idx, [&](int held_slot) {
+        const int level = held_slot / _recordCount;
+        if (!_histStagePosArr.empty() && _histStageRecordIdx % (1 << level) == 0 && held_slot == histLevelSlot(level, _histStageRecordIdx)) {
+            return _histStagePosArr[body_idx];
+        }
+        if (_historyEncoding == HistoryEncoding::Fixed16) {
+            return decodeHistPos(_histPackedMat({held_slot, body_idx}), _histAnchorArr[body_idx]);
+        }
+        return _histPosMat({held_slot, body_idx});
+    });
+}
+
+// The recorded velocity of a body in a slot of the history, as in `histPos`.
+//
+vec3 NBodySim::histVel(int slot, int body_idx) const
+{
+    return interpolateHistSlot(slot, body_idx, [&](int held_slot) {
+        const int level = held_slot / _recordCount;
+        if (_histStageRecordIdx % (1 << level) == 0 && held_slot == histLevelSlot(level, _histStageRecordIdx)) {
+            return _histStageVelArr[body_idx];
+        }
+        return _histVelMat({held_slot, body_idx});
+    });
+}
+
+// The slot stands for the record of its level past the oldest one by its offset in the ring of the level. The record lies on
+// a segment of the chain of the body, between the records the search would interpolate it from.
+//
+template<typename Fn> vec3 NBodySim::interpolateHistSlot(int slot, int body_idx, Fn&& heldValue) const
+{
+    const int level       = slot / _recordCount;
+    const int first_level = histFirstLevel(body_idx);
+    if (level >= first_level) {
+        return heldValue(slot);
+    }
+
+    const int level_start = levelOldestRecordIdx(level);
+    const int record_idx  = level_start + (((slot - histLevelSlot(level, level_start)) & (_recordCount - 1)) << level);
+    const int s0_level    = histRecordLevel(record_idx, _histLevelCount, first_level);
+    const int s0_idx      = record_idx & -(1 << s0_level);
+    const int s0_slot     = histLevelSlot(s0_level, s0_idx);
+    if (s0_idx == record_idx) {
+        return heldValue(s0_slot);
+    }
+
+    const int   s1_slot = histRecordSlot(histSegmentEnd(s0_idx, s0_level, first_level), first_level);
+    const float s0_time = _histTimeArr[s0_slot];
+    const float s1_time = _histTimeArr[s1_slot];
+    return glm::mix(heldValue(s0_slot), heldValue(s1_slot), (s1_time > s0_time) ? (_histTimeArr[slot] - s0_time) / (s1_time - s0_time) : 0.0f);
+}
+
+void NBodySim::setHermiteHistory(bool hermiteHistory)
+{
+    if (hermiteHistory == _hermiteHistory) {
+        return;
+    }
+
+    _hermiteHistory = hermiteHistory;
+    if (!hermiteHistory) {
+        _histVelMat = RaggedMatrix<vec3>{};
+        _histStageVelArr.clear();
+    } else if (!_histTimeArr.empty()) {
+        estimateHistVelocities();
+    }
+}
+
+void NBodySim::setHistoryLevelCount(int levelCount)
+{
+    levelCount = std::clamp(levelCount, 1, MaxHistLevelCount);
+    if (levelCount == _histLevelCount) {
+        return;
+    }
+
+    _histLevelCount = levelCount;
+    _recordCount    = std::min(_recordCount, 0x10000 >> (levelCount - 1));
+    if (_bodies.size() > 0) {
+        _step      = 0;
+        _recordIdx = 0;
+        resetHistory();
+        resetSolverState();
+    }
+}
+
+// The records which fit in the new depth keep their place in each level: the oldest record of a level only moves forward,
+// and the records past it are moved to their slots modulo the new depth.
+//
+void NBodySim::setHistoryRecordCount(int recordCount)
+{
+    recordCount = (int)std::bit_ceil((unsigned)std::clamp(recordCount, MinRecordCount, MaxRecordCount));
+    recordCount = std::min(recordCount, 0x10000 >> (_histLevelCount - 1));
+    if (recordCount == _recordCount) {
+        return;
+    }
+
+    if (_bodies.size() == 0 || !keepsHistory()) {
+        _recordCount = recordCount;
+        return;
+    }
+
+    for (int level = 0; level < _histLevelCount; ++level) {
+        _histLevelBeginArr[level] = levelOldestRecordIdx(level);
+    }
+    const int prevRecordCount = _recordCount;
+    _recordCount              = recordCount;
+
+    const int  slotCount = _histLevelCount * _recordCount;
+    const auto prevSlot  = [&](int slot, int record_idx) {
+        const int level = slot / _recordCount;
+        return level * prevRecordCount + (record_idx >> level) % prevRecordCount;
+    };
+    const auto moveSlots = [&]<typename T>(RaggedMatrix<T>& mat) {
+        RaggedMatrix<T> moved(slotCount, histRowStarts(mat.rowCount() > _sourceCount), T{});
+        _threadPool->parallelFor(_sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+            for (int ib = begin; ib < end; ++ib) {
+                forEachHistSlot([&](int slot, int ir) { moved({slot, ib}) = mat({prevSlot(slot, ir), ib}); }, histFirstLevel(ib));
+            }
+        });
+        mat = std::move(moved);
+    };
+
+    vector<float> timeArr(slotCount);
+    forEachHistSlot([&](int slot, int ir) { timeArr[slot] = _histTimeArr[prevSlot(slot, ir)]; });
+    _histTimeArr = std::move(timeArr);
+
+    if (_historyEncoding == HistoryEncoding::Fixed16) {
+        moveSlots(_histPackedMat);
+    } else {
+        moveSlots(_histPosMat);
+    }
+    if (_hermiteHistory) {
+        moveSlots(_histVelMat);
+    }
+
+    if (_octree) {
+        _octree->rebuild(*this);
+    }
+}
+
+// Sizes the history to the delay of the signals across the system, with a margin. The system is measured by its radius around
+// the centroid, and the delay converted to records by the pace observed in the dense level, as the time step varies. Until the
+// next check, the fastest body may widen the system by twice the distance it travels, so the history covers that as well.
+// The coarsest level spans the delay, and each finer one half of it: the searches of the bodies and of the octree cells walk
+// all the levels, so the dense level only needs to cover the nearby sources.
+//
+void NBodySim::adaptHistoryDepth()
+{
+    const auto body_pos_arr = _bodies.field<&Body::pos>();
+    const auto body_vel_arr = _bodies.field<&Body::vel>();
+    const int  rec_start    = levelOldestRecordIdx(0);
+    if (_recordIdx - rec_start < HistDepthCheckInterval) {
+        return;
+    }
+
+    vec3 center{};
+    for (const vec3& pos : body_pos_arr) {
+        center += pos;
+    }
+    center /= (float)_bodies.size();
+
+    float radius2 = 0.0f;
+    float speed2  = 0.0f;
+    for (int ib = 0; ib < _bodies.size(); ++ib) {
+        radius2 = std::max(radius2, glm::distance2(center, body_pos_arr[ib]));
+        speed2  = std::max(speed2, glm::length2(body_vel_arr[ib]));
+    }
+
+    const float recordTime   = (_time - _histTimeArr[histLevelSlot(0, rec_start)]) / (float)(_recordIdx - rec_start);
+    const float diameter     = 2.0f * (std::sqrt(radius2) + std::sqrt(speed2) * recordTime * HistDepthCheckInterval);
+    const float levelRecords = HistDepthMargin * lightDelay(diameter * diameter) / recordTime / (float)(1 << (_histLevelCount - 1));
+    const int   recordCount  = (int)std::bit_ceil((unsigned)std::min(levelRecords + 1.0f, (float)MaxRecordCount));
+
+    if (recordCount > _recordCount || 4 * recordCount <= _recordCount) {
+        setHistoryRecordCount(recordCount);
+    }
+}
+
+// The bodies refine as soon as their finest level gets too coarse for the tolerance, and coarsen to the coarsest level which
+// keeps the error within a quarter of the tolerance, so that they do not flip between two levels.
+//
+void NBodySim::adaptHistorySampling()
+{
+    const auto body_accel_arr      = _bodies.field<&Body::accel>();
+    const auto body_accel_prev_arr = _bodies.field<&Body::accelPrev>();
+    const int  rec_start           = levelOldestRecordIdx(0);
+    if (_recordIdx == rec_start) {
+        return;
+    }
+
+    const float recordTime    = (_time - _histTimeArr[histLevelSlot(0, rec_start)]) / (float)(_recordIdx - rec_start);
+    vector<int> firstLevelArr = _histFirstLevelArr;
+    for (int ib = 0; ib < _sourceCount; ++ib) {
+        const float accel      = std::sqrt(std::max(glm::length2(body_accel_arr[ib]), glm::length2(body_accel_prev_arr[ib])));
+        const auto  levelError = [&](int level) {
+            const float segTime = (float)(1 << level) * recordTime;
+            return accel * segTime * segTime / 8.0f;
+        };
+
+        int& first_level = firstLevelArr[ib];
+        while (first_level > 0 && levelError(first_level) > _samplingTolerance) {
+            --first_level;
+        }
+        if (first_level == _histFirstLevelArr[ib]) {
+            while (first_level + 1 < _histLevelCount && levelError(first_level + 1) <= 0.25f * _samplingTolerance) {
+                ++first_level;
+            }
+        }
+    }
+
+    if (firstLevelArr != _histFirstLevelArr) {
+        resampleHistory(std::move(firstLevelArr));
+    }
+}
+
+// The newest record is staged while the sampling is adaptive, in either encoding, as the rows of the bodies may not hold it.
+//
+void NBodySim::setAdaptiveSampling(bool adaptiveSampling)
+{
+    if (adaptiveSampling == _adaptiveSampling) {
+        return;
+    }
+
+    _adaptiveSampling = adaptiveSampling;
+    if (_histTimeArr.empty()) {
+        return;
+    }
+
+    const int sourceCount = _sourceCount;
+    if (adaptiveSampling) {
+        _histFirstLevelArr.assign(sourceCount, 0);
+        if (_historyEncoding == HistoryEncoding::Fixed16) {
+            _histStagePosArr.resize(sourceCount);
+            for (int ib = 0; ib < sourceCount; ++ib) {
+                _histStagePosArr[ib] = decodeHistPos(_histPackedMat({histLevelSlot(0, _recordIdx), ib}), _histAnchorArr[ib]);
+            }
+            _histStageRecordIdx = _recordIdx;
+        }
+        return;
+    }
+
+    resampleHistory(vector<int>(sourceCount, 0));
+    _histFirstLevelArr.clear();
+    if (_historyEncoding == HistoryEncoding::Fixed16) {
+        for (int ib = 0; ib < sourceCount; ++ib) {
+            recordPackedPos(_recordIdx, ib, _histStagePosArr[ib]);
+        }
+        _histStagePosArr.clear();
+    }
+}
+
+// The first slot of the row of each source, at its finest level, and of the spare row of the compressed history if requested.
+//
+vector<int> NBodySim::histRowStarts(bool spareRow) const
+{
+    const int   slotCount = _histLevelCount * _recordCount;
+    vector<int> rowStarts(_sourceCount + (spareRow ? 1 : 0), 0);
+    for (int ib = 0; ib < (int)_histFirstLevelArr.size(); ++ib) {
+        rowStarts[ib] = _histFirstLevelArr[ib] * _recordCount;
+    }
+    if (spareRow) {
+        rowStarts.back() = slotCount - 1;
+    }
+    return rowStarts;
+}
+
+// Moves the rows of the history to new finest levels of the bodies. The rows of a body getting coarser drop their finest levels,
+// and those of a body getting finer gain the records of its new levels, interpolated as in `histPos` and `histVel`. The newest
+// record stays staged. The compressed positions of the gained records get encoded once the rows have moved.
+//
+void NBodySim::resampleHistory(vector<int> firstLevelArr)
+{
+    const int  sourceCount = _sourceCount;
+    const int  slotCount   = _histLevelCount * _recordCount;
+    const bool packed      = _historyEncoding == HistoryEncoding::Fixed16;
+
+    vector<int> rowStarts(sourceCount + 1, slotCount - 1);
+    for (int ib = 0; ib < sourceCount; ++ib) {
+        rowStarts[ib] = firstLevelArr[ib] * _recordCount;
+    }
+    const auto sourceRowStarts = std::span<const int>(rowStarts).first(sourceCount);
+
+    RaggedMatrix<vec3>          posMat(slotCount, packed ? std::span<const int>{} : sourceRowStarts, vec3{});
+    RaggedMatrix<PackedHistPos> packedMat(slotCount, packed ? std::span<const int>(rowStarts) : std::span<const int>{}, PackedHistPos{});
+    RaggedMatrix<vec3>          velMat(slotCount, _hermiteHistory ? sourceRowStarts : std::span<const int>{}, vec3{});
+    vector<vector<std::pair<int, vec3>>> gainedPosArr(packed ? sourceCount : 0);
+
+    _threadPool->parallelFor(sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+        for (int ib = begin; ib < end; ++ib) {
+            const int first_level = histFirstLevel(ib);
+            forEachHistSlot(
+                [&](int slot, int ir) {
+                    if (!packed) {
+                        posMat({slot, ib}) = histPos(slot, ib);
+                    } else if (slot / _recordCount >= first_level) {
+                        packedMat({slot, ib}) = _histPackedMat({slot, ib});
+                    } else {
+                        gainedPosArr[ib].emplace_back(ir, histPos(slot, ib));
+                    }
+                    if (_hermiteHistory) {
+                        velMat({slot, ib}) = histVel(slot, ib);
+                    }
+                },
+                firstLevelArr[ib]);
+        }
+    });
+
+    _histFirstLevelArr = std::move(firstLevelArr);
+    _histPosMat        = std::move(posMat);
+    _histPackedMat     = std::move(packedMat);
+    _histVelMat        = std::move(velMat);
+
+    for (int ib = 0; ib < (int)gainedPosArr.size(); ++ib) {
+        for (const auto& [ir, pos] : gainedPosArr[ib]) {
+            recordPackedPos(ir, ib, pos);
+        }
+    }
+}
+
+void NBodySim::setThreadCount(int threadCount)
+{
+    if (threadCount <= 0) {
+        threadCount = ThreadPool::hardwareThreadCount();
+    }
+    if (!_threadPool || _threadPool->threadCount() != threadCount) {
+        _threadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+void NBodySim::setForceSolver(ForceSolver forceSolver)
+{
+    if (forceSolver != _forceSolver) {
+        _forceSolver = forceSolver;
+        resetSolverState();
+    }
+}
+
+void NBodySim::setExactSearch(ExactSearch exactSearch)
+{
+    if (exactSearch != _exactSearch) {
+        _exactSearch = exactSearch;
+        if (_bodies.size() > 0) {
+            resetSolverState();
+        }
+    }
+}
+
+void NBodySim::setAnalyticFallback(bool analyticFallback)
+{
+    if (analyticFallback != _analyticFallback) {
+        _analyticFallback = analyticFallback;
+        if (_bodies.size() > 0) {
+            resetSolverState();
+        }
+    }
+}
+
+// Allocates the acceleration structures of the active solver and releases those of the others.
+// The position history is shared by the retarded solvers, so switching between them does not interrupt the simulation.
+//
+void NBodySim::resetSolverState()
+{
+    const int tileCount = (_bodies.size() + ExactTileSize - 1) / ExactTileSize;
+
+    if (!keepsHistory() && !_histTimeArr.empty()) {
+        resetHistory();
+    } else if (keepsHistory() && _histTimeArr.empty()) {
+        extrapolateHistory();
+    }
+
+    // The entries start a full period of the record tags behind the newest record, older than any record of the history, so
+    // their searches start from the guesses of the next step. The coherent search keeps only the crossings shared by the tiles,
+    // and the cacheless one neither.
+    if (_forceSolver == ForceSolver::Exact && _exactSearch == ExactSearch::Cached) {
+        assert((_recordCount << (_histLevelCount - 1)) <= 0x10000);
+        _histInterMat.reset({ExactTileSize, tileCount * _sourceCount}, LightIntersectCacheEntry{(uint16_t)((_recordIdx + 1) & 0xffff), 0});
+    } else {
+        _histInterMat = Matrix<LightIntersectCacheEntry>{};
+    }
+    if (_forceSolver == ForceSolver::Exact && _exactSearch == ExactSearch::Coherent) {
+        _tileCrossingMat.reset({_sourceCount, tileCount}, TileCrossing{.recordIdx = -1});
+    } else {
+        _tileCrossingMat = Matrix<TileCrossing>{};
+    }
+
+    if (_forceSolver == ForceSolver::Exact) {
+        updateRecordGuesses();
+    } else {
+        _recordGuessArr.clear();
+        _horizonSkipMat   = Matrix<uint8_t>{};
+        _horizonSkipCount = 0;
+        _tileReachArr.clear();
+    }
+
+    if (_forceSolver == ForceSolver::BarnesHut || _forceSolver == ForceSolver::Fmm) {
+        _octree = std::make_unique<RetardedOctree>(_forceSolver == ForceSolver::Fmm);
+        _octree->rebuild(*this);
+    } else {
+        _octree.reset();
+    }
+
+    if (_forceSolver == ForceSolver::Fmm) {
+        _fmm = std::make_unique<RetardedFmm>();
+    } else {
+        _fmm.reset();
+    }
+
+    if (_forceSolver != ForceSolver::Analytic) {
+        _sourceJerkArr.clear();
+        _analyticFallbackCount = 0;
+    }
+}
+
+void NBodySim::step(float dt)
+{
+    dt = std::min(dt, 0.01f);
+    dt = std::max(dt, 0.0001f);
+
+    // Compute all-to-all accelerations between bodies for the current/last frame.
+    //
+    if (_bodies.size() == 0) {
+        return;
+    }
+
+    const auto body_accel_prev_arr = _bodies.field<&Body::accelPrev>();
+    const auto body_accel_arr      = _bodies.field<&Body::accel>();
+
+    if (_forceSolver == ForceSolver::Analytic) {
+        updateSourceJerks();
+    }
+    std::ranges::copy(body_accel_arr, body_accel_prev_arr.begin());
+    std::ranges::fill(body_accel_arr, vec3{});
+    _outOfWindowCounter = 0;
+
+    switch (_forceSolver) {
+        case ForceSolver::Exact: {
+            applyExactGravAccels();
+            break;
+        }
+
+        case ForceSolver::BarnesHut: {
+            _octree->applyGravAccels(*this);
+            break;
+        }
+
+        case ForceSolver::Fmm: {
+            _fmm->applyGravAccels(*this, *_octree);
+            break;
+        }
+
+        case ForceSolver::Newtonian: {
+            applyNewtonianGravAccels();
+            break;
+        }
+
+        case ForceSolver::Analytic: {
+            applyAnalyticGravAccels();
+            break;
+        }
+    }
+
+    _outOfWindowCount = _outOfWindowCounter;
+    _outOfWindowTotal += _outOfWindowCount;
+
+    if (_forceErrorSampleCount > 0) {
+        _forceErrorStats = measureForceError(_forceErrorSampleCount);
+    }
+    if (!_escapedArr.empty()) {
+        applyEscapedPull();
+    }
+
+    // Progress the counters to the next simulation frame.
+    //
+    ++_step;
+    if (_step % _recordStepInterval == 1 % _recordStepInterval) {
+        ++_recordIdx;
+    }
+
+    _time += dt;
+    _stepDt = dt;
+
+    const bool recording = keepsHistory();
+    if (recording) {
+        forEachRecordSlot(_recordIdx, [&](int slot) { _histTimeArr[slot] = _time; });
+    }
+
+    integrate(dt);
+    if (recording) {
+        recordHistory();
+    }
+    if (_mergeOnContact) {
+        mergeTouchingBodies();
+    }
+    if (_escapeRadius > 0.0f && _step % (_recordStepInterval * HistDepthCheckInterval) == 1) {
+        removeEscapers();
+    }
+
+    if (_reorderInterval > 0 && _recordIdx - _reorderRecordIdx >= _reorderInterval) {
+        reorderBodies();
+    }
+
+    if (recording && _step % (_recordStepInterval * HistDepthCheckInterval) == 1) {
+        if (_adaptiveHistory) {
+            adaptHistoryDepth();
+        }
+        if (_adaptiveSampling) {
+            adaptHistorySampling();
+        }
+    }
+
+    if (_octree) {
+        _octree->update(*this);
+    }
+}
+
+// Updates the positions and velocities of all bodies. The escaped sources move on at their velocities.
+//
+void NBodySim::integrate(float dt)
+{
+    const auto body_pos_arr        = _bodies.field<&Body::pos>();
+    const auto body_vel_arr        = _bodies.field<&Body::vel>();
+    const auto body_accel_prev_arr = _bodies.field<&Body::accelPrev>();
+    const auto body_accel_arr      = _bodies.field<&Body::accel>();
+
+    _threadPool->parallelFor(_bodies.size(), IntegrationChunkSize, [&](int begin, int end) {
+        for (int ib = begin; ib < end; ++ib) {
+            vec3& body_pos = body_pos_arr[ib];
+            vec3& body_vel = body_vel_arr[ib];
+
+            auto       vel0      = body_vel;
+            const auto vel0_len2 = glm::length2(body_vel);
+            if (vel0_len2 > MaxSpeedCap * MaxSpeedCap) {
+                vel0 *= MaxSpeedCap * MaxSpeedCap / vel0_len2;
+            }
+            assert(glm::length(vel0) < LightSpeed);
+
+            auto       vel_delta      = 0.5f * (body_accel_prev_arr[ib] + body_accel_arr[ib]) * GravConst * dt;
+            const auto vel_delta_len2 = glm::length2(vel_delta);
+            if (vel_delta_len2 > MaxSpeedCap * MaxSpeedCap) {
+                vel_delta *= MaxSpeedCap * MaxSpeedCap / vel_delta_len2;
+            }
+            assert(glm::length(vel_delta) < LightSpeed);
+
+            if (glm::length2(vel_delta) > 0.0f) {
+                // Split vel0 into 2 components: colinear to vel_delta and orthogonal to it.
+                const auto vel0_coll = vel_delta * glm::dot(vel0, vel_delta) / glm::length2(vel_delta);
+                const auto vel0_orho = vel0 - vel0_coll;
+
+                body_vel = ((vel0_coll + vel_delta) + vel0_orho * std::sqrt(1.0f - glm::length2(vel_delta) * LightSpeedInvSq)) / (1.0f + glm::dot(vel_delta, vel0_coll) * LightSpeedInvSq);
+
+                const auto body_vel_len2 = glm::length2(body_vel);
+                if (body_vel_len2 > MaxSpeedCap * MaxSpeedCap) {
+                    body_vel *= MaxSpeedCap * MaxSpeedCap / body_vel_len2;
+                }
+
+                assert(glm::length(body_vel) < LightSpeed);
+            }
+
+            body_pos += dt * 0.5f * (vel0 + body_vel);
+        }
+    });
+
+    for (Body& escaped : _escapedArr) {
+        escaped.pos += dt * escaped.vel;
+    }
+}
+
+// Stores the current positions in the history record being filled, in each level it belongs to. The full history stages the
+// record in a time-major row, which each step overwrites contiguously, and moves it into the rows of the bodies once the next
+// record starts: one pass over the rows every `recordStepInterval` steps, rather than a write to each row in every step.
+// The compressed history records in place, as its grid follows each body, unless the sampling is adaptive. The velocities of
+// the Hermite interpolation are staged in either encoding. Only the sources keep a history.
+//
+void NBodySim::recordHistory()
+{
+    const auto body_pos_arr = _bodies.field<&Body::pos>().first(_sourceCount);
+
+    if (_histStageRecordIdx != _recordIdx) {
+        commitStagedRecord();
+        _histStageRecordIdx = _recordIdx;
+    }
+    if (_hermiteHistory) {
+        std::ranges::copy(_bodies.field<&Body::vel>().first(_sourceCount), _histStageVelArr.begin());
+    }
+    if (!_histStagePosArr.empty()) {
+        std::ranges::copy(body_pos_arr, _histStagePosArr.begin());
+        return;
+    }
+
+    _threadPool->parallelFor(_sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+        for (int ib = begin; ib < end; ++ib) {
+            recordPackedPos(_recordIdx, ib, body_pos_arr[ib]);
+        }
+    });
+}
+
+// Moves the staged record into the rows of the history, in each level it belongs to from the finest one of each body. The
+// threads take chunks of bodies, whose rows thus get the record in turn. The compressed history encodes the staged positions
+// of the adaptive sampling.
+//
+void NBodySim::commitStagedRecord()
+{
+    const bool stagedPos = !_histStagePosArr.empty();
+    const bool packed    = _historyEncoding == HistoryEncoding::Fixed16;
+    if (!stagedPos && !_hermiteHistory) {
+        return;
+    }
+
+    _threadPool->parallelFor(_sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+        for (int ib = begin; ib < end && stagedPos && packed; ++ib) {
+            recordPackedPos(_histStageRecordIdx, ib, _histStagePosArr[ib]);
+        }
+        forEachRecordSlot(_histStageRecordIdx, [&](int slot) {
+            for (int ib = begin; ib < end && stagedPos && !packed; ++ib) {
+                if (slot >= _histPosMat.rowStart(ib)) {
+                    _histPosMat({slot, ib}) = _histStagePosArr[ib];
+                }
+            }
+            for (int ib = begin; ib < end && _hermiteHistory; ++ib) {
+                if (slot >= _histVelMat.rowStart(ib)) {
+                    _histVelMat({slot, ib}) = _histStageVelArr[ib];
+                }
+            }
+        });
+    });
+}
+
+// Starts the velocities of a history recorded without them: each record takes the slope of the chord between its neighbours in
+// its level, or between itself and its only neighbour at an end of the level, and the newest one the current velocity.
+//
+void NBodySim::estimateHistVelocities()
+{
+    const auto body_vel_arr = _bodies.field<&Body::vel>().first(_sourceCount);
+
+    _histVelMat.reset(_histLevelCount * _recordCount, histRowStarts(false), vec3{});
+    _histStageVelArr.assign(body_vel_arr.begin(), body_vel_arr.end());
+    _histStageRecordIdx = _recordIdx;
+
+    _threadPool->parallelFor(_sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+        for (int ib = begin; ib < end; ++ib) {
+            for (int level = histFirstLevel(ib); level < _histLevelCount; ++level) {
+                const int first = levelOldestRecordIdx(level);
+                const int last  = _recordIdx & -(1 << level);
+                for (int ir = first; ir <= last; ir += 1 << level) {
+                    const int   prev_slot  = histLevelSlot(level, std::max(ir - (1 << level), first));
+                    const int   next_slot  = histLevelSlot(level, std::min(ir + (1 << level), last));
+                    const float chord_time = _histTimeArr[next_slot] - _histTimeArr[prev_slot];
+
+                    _histVelMat({histLevelSlot(level, ir), ib}) = (chord_time > 0.0f) ? (histPos(next_slot, ib) - histPos(prev_slot, ib)) / chord_time : body_vel_arr[ib];
+                }
+            }
+        }
+    });
+}
+
+// Starts the history of the sources with their current positions, in the active encoding, if the active solver keeps one.
+//
+void NBodySim::resetHistory()
+{
+    const int  sourceCount  = _sourceCount;
+    const auto body_pos_arr = _bodies.field<&Body::pos>().first(sourceCount);
+    const int  slotCount    = _histLevelCount * _recordCount;
+
+    std::ranges::fill(_histLevelBeginArr, 0);
+    _histFirstLevelArr.clear();
+    if (!keepsHistory()) {
+        _histTimeArr.clear();
+        _histPosMat = RaggedMatrix<vec3>{};
+        _histStagePosArr.clear();
+        _histPackedMat = RaggedMatrix<PackedHistPos>{};
+        _histAnchorArr.clear();
+        _histVelMat = RaggedMatrix<vec3>{};
+        _histStageVelArr.clear();
+        return;
+    }
+    if (_adaptiveSampling) {
+        _histFirstLevelArr.assign(sourceCount, 0);
+    }
+
+    _histTimeArr.resize(slotCount);
+    forEachRecordSlot(_recordIdx, [&](int slot) { _histTimeArr[slot] = _time; });
+    _histStageRecordIdx = _recordIdx;
+
+    if (_hermiteHistory) {
+        const auto body_vel_arr = _bodies.field<&Body::vel>().first(sourceCount);
+        _histVelMat.reset(slotCount, histRowStarts(false), vec3{});
+        _histStageVelArr.assign(body_vel_arr.begin(), body_vel_arr.end());
+    }
+
+    if (_historyEncoding == HistoryEncoding::Fixed16) {
+        _histPackedMat.reset(slotCount, histRowStarts(true), PackedHistPos{});
+        _histAnchorArr.assign(sourceCount, HistAnchor{ivec3{0}, HistMinScale, 0.5f * HistMinScale});
+        for (int ib = 0; ib < sourceCount; ++ib) {
+            recordPackedPos(_recordIdx, ib, body_pos_arr[ib]);
+        }
+    } else {
+        _histPosMat.reset(slotCount, histRowStarts(false), vec3{});
+    }
+    if (_historyEncoding == HistoryEncoding::Full || _adaptiveSampling) {
+        _histStagePosArr.assign(body_pos_arr.begin(), body_pos_arr.end());
+    } else {
+        _histStagePosArr.clear();
+    }
+}
+
+// Starts the history of a solver taking over from one which keeps none, e.g. the Newtonian one. The bodies are taken to have moved
+// along straight lines at their current velocities, below the speed of light, with the records at the pace of the last step. The
+// record index moves forward if needed, so that all the levels are full.
+//
+void NBodySim::extrapolateHistory()
+{
+    _recordIdx = std::max(_recordIdx, _recordCount << (_histLevelCount - 1));
+    resetHistory();
+
+    const auto  body_pos_arr = _bodies.field<&Body::pos>();
+    const auto  body_vel_arr = _bodies.field<&Body::vel>();
+    const float recordTime   = (float)_recordStepInterval * _stepDt;
+    const int   rec_start    = oldestRecordIdx();
+
+    forEachHistSlot([&](int slot, int ir) { _histTimeArr[slot] = _time - (float)(_recordIdx - ir) * recordTime; });
+
+    _threadPool->parallelFor(_sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+        for (int ib = begin; ib < end; ++ib) {
+            const auto pastPos = [&](int record_idx) { return body_pos_arr[ib] - body_vel_arr[ib] * (_time - _histTimeArr[histRecordSlot(record_idx)]); };
+            if (_historyEncoding == HistoryEncoding::Fixed16) {
+                for (int ir = rec_start; ir < _recordIdx; ++ir) {
+                    if (ir % (1 << histRecordLevel(ir, _histLevelCount)) == 0) {
+                        recordPackedPos(ir, ib, pastPos(ir));
+                    }
+                }
+            } else {
+                forEachHistSlot([&](int slot, int ir) { _histPosMat({slot, ib}) = pastPos(ir); });
+            }
+            if (_hermiteHistory) {
+                forEachHistSlot([&](int slot, int) { _histVelMat({slot, ib}) = body_vel_arr[ib]; });
+            }
+        }
+    });
+}
+
+// Stores a position in the compressed history of a body, in each level the record belongs to. If its offset does not fit in
+// 16 bits, the grid gets centered on the positions still in the history, and doubled until they fit. Doubling rounds these
+// positions to the coarser grid, which adds half of its spacing to their error bound.
+//
+void NBodySim::recordPackedPos(int record_idx, int body_idx, const vec3& pos)
+{
+    constexpr int MaxOffset = 32767;
+    constexpr int MaxCode   = 1 << 24;  // The grid points beyond are not exact floats.
+
+    HistAnchor& anchor      = _histAnchorArr[body_idx];
+    const auto  row         = _histPackedMat.row(body_idx);
+    const int   first_level = histFirstLevel(body_idx);
+    const int   first_slot  = _histPackedMat.rowStart(body_idx);
+
+    const auto storeOffset = [&](const ivec3& offset) {
+        forEachRecordSlot(record_idx, [&](int slot) { row[slot - first_slot] = PackedHistPos{(int16_t)offset.x, (int16_t)offset.y, (int16_t)offset.z}; }, first_level);
+    };
+
+    const vec3 grid = glm::round(pos / anchor.scale);
+    if (glm::all(glm::lessThan(glm::abs(grid), vec3(MaxCode)))) {
+        const ivec3 offset = ivec3(grid) - anchor.originCode;
+        if (glm::all(glm::lessThanEqual(glm::abs(offset), ivec3(MaxOffset)))) {
+            storeOffset(offset);
+            return;
+        }
+    }
+
+    // The grid points of the other records still in the history.
+    vector<std::pair<int, ivec3>> codes;
+    forEachHistSlot(
+        [&](int is, int ir) {
+            if (ir != record_idx) {
+                const PackedHistPos& pos = row[is - first_slot];
+                codes.emplace_back(is - first_slot, anchor.originCode + ivec3(pos.x, pos.y, pos.z));
+            }
+        },
+        first_level);
+
+    while (true) {
+        const vec3 grid = glm::round(pos / anchor.scale);
+        if (glm::all(glm::lessThan(glm::abs(grid), vec3(MaxCode)))) {
+            ivec3 lo = ivec3(grid);
+            ivec3 hi = ivec3(grid);
+            for (const auto& [is, code] : codes) {
+                lo = glm::min(lo, code);
+                hi = glm::max(hi, code);
+            }
+
+            if (glm::all(glm::lessThanEqual(hi - lo, ivec3(2 * MaxOffset)))) {
+                anchor.originCode = lo + (hi - lo) / 2;
+                for (const auto& [is, code] : codes) {
+                    const ivec3 offset = code - anchor.originCode;
+                    row[is]            = PackedHistPos{(int16_t)offset.x, (int16_t)offset.y, (int16_t)offset.z};
+                }
+                storeOffset(ivec3(grid) - anchor.originCode);
+                return;
+            }
+        }
+
+        // Double the grid, rounding the grid points half away from zero.
+        anchor.scale *= 2.0f;
+        anchor.errorBound += 0.5f * anchor.scale;
+        for (auto& [is, code] : codes) {
+            code = glm::sign(code) * ((glm::abs(code) + 1) / 2);
+        }
+    }
+}
+
+// Interleaves the bits of the cell coordinates of a point, up to 21 bits each, into its index along the Morton curve.
+//
+static uint64_t mortonCode(uint32_t x, uint32_t y, uint32_t z)
+{
+    const auto spread = [](uint64_t v) {
+        v = (v | v << 32) & 0x001f00000000ffffull;
+        v = (v | v << 16) & 0x001f0000ff0000ffull;
+        v = (v | v << 8) & 0x100f00f00f00f00full;
+        v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+        v = (v | v << 2) & 0x1249249249249249ull;
+        return v;
+    };
+    return spread(x) | spread(y) << 1 | spread(z) << 2;
+}
+
+// The order of the bodies along the Morton curve through the cells of their bounding cube, i.e. the depth-first order of an
+// octree over the cube, in which the bodies of each cell are contiguous. The sources precede the tracers, each in their own
+// Morton order. Returns the current index of the body to move to each index.
+//
+vector<int> NBodySim::spatialOrder() const
+{
+    constexpr int CellBits = 21;
+
+    const auto body_pos_arr  = _bodies.field<&Body::pos>();
+    const auto body_mass_arr = _bodies.field<&Body::mass>();
+    const int  bodyCount     = _bodies.size();
+    if (bodyCount == 0) {
+        return {};
+    }
+
+    vec3 boundsMin = body_pos_arr[0];
+    vec3 boundsMax = body_pos_arr[0];
+    for (const vec3& pos : body_pos_arr) {
+        boundsMin = glm::min(boundsMin, pos);
+        boundsMax = glm::max(boundsMax, pos);
+    }
+    const vec3  extent    = boundsMax - boundsMin;
+    const float cellScale = (float)((1 << CellBits) - 1) / std::max({extent.x, extent.y, extent.z, 1e-20f});
+
+    vector<std::pair<uint64_t, int>> keys(bodyCount);
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        const ivec3 cell = glm::clamp(ivec3((body_pos_arr[ib] - boundsMin) * cellScale), ivec3(0), ivec3((1 << CellBits) - 1));
+        keys[ib]         = {(uint64_t)isTracerMass(body_mass_arr[ib]) << 63 | mortonCode(cell.x, cell.y, cell.z), ib};
+    }
+    std::ranges::sort(keys);
+
+    vector<int> order(bodyCount);
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        order[ib] = keys[ib].second;
+    }
+    return order;
+}
+
+// Moves the bodies to a new order, in which the body at index `i` is the one which was at index `order[i]`, along with their IDs.
+//
+void NBodySim::permuteBodies(std::span<const int> order)
+{
+    const int bodyCount = _bodies.size();
+
+    ++_reorderCount;
+    _bodies.permute(order);
+    const vector<int> body_id_arr = std::exchange(_bodyIdArr, vector<int>(bodyCount));
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        _bodyIdArr[ib]              = body_id_arr[order[ib]];
+        _bodyIdxArr[_bodyIdArr[ib]] = ib;
+    }
+}
+
+// Moves the bodies to their places along the Morton curve, with all the state kept for them: their history rows, the entries
+// of the light intersection cache of each pair, and the members of the octree cells. The crossings shared by the tiles of the
+// coherent search get searched anew, as the tiles hold other targets now; the horizon flags are rebuilt in each step anyway.
+//
+void NBodySim::reorderBodies()
+{
+    const int  bodyCount = _bodies.size();
+    const auto order     = spatialOrder();
+
+    _reorderRecordIdx = _recordIdx;
+    if (std::ranges::is_sorted(order)) {
+        return;
+    }
+
+    vector<int> new_idx_arr(bodyCount);
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        new_idx_arr[order[ib]] = ib;
+    }
+    permuteBodies(order);
+
+    // The sources stay ahead of the tracers, so the arrays of the sources follow the first part of the order.
+    const auto permute = [&]<typename T>(vector<T>& arr) {
+        vector<T> permuted(arr.size());
+        for (int ib = 0; ib < (int)arr.size(); ++ib) {
+            permuted[ib] = arr[order[ib]];
+        }
+        arr = std::move(permuted);
+    };
+    if (!_histFirstLevelArr.empty()) {
+        permute(_histFirstLevelArr);
+    }
+
+    // The rows keep their lengths, and the spare row of the compressed history stays last.
+    const auto permuteRows = [&]<typename T>(RaggedMatrix<T>& mat) {
+        vector<int> rowStarts(mat.rowCount());
+        for (int ib = 0; ib < mat.rowCount(); ++ib) {
+            rowStarts[ib] = mat.rowStart(ib < _sourceCount ? order[ib] : ib);
+        }
+        RaggedMatrix<T> permuted(mat.width(), rowStarts, T{});
+        _threadPool->parallelFor(_sourceCount, IntegrationChunkSize, [&](int begin, int end) {
+            for (int ib = begin; ib < end; ++ib) {
+                std::ranges::copy(mat.row(order[ib]), permuted.row(ib).begin());
+            }
+        });
+        mat = std::move(permuted);
+    };
+
+    if (_histPackedMat.rowCount() > 0) {
+        permuteRows(_histPackedMat);
+        permute(_histAnchorArr);
+    } else if (_histPosMat.rowCount() > 0) {
+        permuteRows(_histPosMat);
+    }
+    if (!_histStagePosArr.empty()) {
+        permute(_histStagePosArr);
+    }
+    if (_histVelMat.rowCount() > 0) {
+        permuteRows(_histVelMat);
+        permute(_histStageVelArr);
+    }
+
+    // Each tile of targets gathers the entries of its new members, source by source. The lanes past the last body stay cold.
+    if (_histInterMat.size().y > 0) {
+        const int                        tileCount = (bodyCount + ExactTileSize - 1) / ExactTileSize;
+        Matrix<LightIntersectCacheEntry> permuted(_histInterMat.size(), LightIntersectCacheEntry{(uint16_t)((_recordIdx + 1) & 0xffff), 0});
+        _threadPool->parallelFor(tileCount, 1, [&](int begin, int end) {
+            for (int tile = begin; tile < end; ++tile) {
+                const int tileBegin = tile * ExactTileSize;
+                const int tileEnd   = std::min(tileBegin + ExactTileSize, bodyCount);
+                for (int is = 0; is < _sourceCount; ++is) {
+                    const auto row = permuted.row(tile * _sourceCount + is);
+                    for (int it = tileBegin; it < tileEnd; ++it) {
+                        row[it - tileBegin] = interCacheEntry(order[it], order[is]);
+                    }
+                }
+            }
+        });
+        _histInterMat = std::move(permuted);
+    }
+
+    if (_tileCrossingMat.size().y > 0) {
+        _tileCrossingMat.clear(TileCrossing{.recordIdx = -1});
+    }
+
+    if (_octree) {
+        _octree->remapBodies(new_idx_arr);
+    }
+}
+
+// Finds the touching pairs by sweeping the spheres of the bodies along the x axis, in the order of their lowest points, and merges
+// each group of bodies touching in a chain into its heaviest body, a source. With the weights γm of their energies, the merged
+// body moves with the velocity of the total momentum of the group, Σγmv / Σγm, and its rest mass is the invariant mass of the
+// group, √((Σγm)² - |Σγmv|²/c²). Its accelerations are the averages with the same weights, which the integration of the next
+// step continues from. It stays where the heaviest body was: a jump to the center of energy would put a segment faster than
+// light into its history, which the light cone of a target could cross more than once.
+//
+void NBodySim::mergeTouchingBodies()
+{
+    const auto body_pos_arr        = _bodies.field<&Body::pos>();
+    const auto body_vel_arr        = _bodies.field<&Body::vel>();
+    const auto body_mass_arr       = _bodies.field<&Body::mass>();
+    const auto body_accel_prev_arr = _bodies.field<&Body::accelPrev>();
+    const auto body_accel_arr      = _bodies.field<&Body::accel>();
+    const int  bodyCount           = _bodies.size();
+
+    vector<float> radius_arr(bodyCount);
+    vector<int>   sweep(bodyCount);
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        radius_arr[ib] = bodyRadius(body_mass_arr[ib]);
+    }
+    std::iota(sweep.begin(), sweep.end(), 0);
+    std::ranges::sort(sweep, {}, [&](int ib) { return body_pos_arr[ib].x - radius_arr[ib]; });
+
+    // The groups are linked to the lowest index among their bodies.
+    vector<int> group_arr(bodyCount);
+    std::iota(group_arr.begin(), group_arr.end(), 0);
+    const auto findGroup = [&](int ib) {
+        while (group_arr[ib] != ib) {
+            ib = group_arr[ib] = group_arr[group_arr[ib]];
+        }
+        return ib;
+    };
+
+    bool touching = false;
+    for (int i = 0; i < bodyCount; ++i) {
+        const int   ib    = sweep[i];
+        const float x_max = body_pos_arr[ib].x + radius_arr[ib];
+        for (int j = i + 1; j < bodyCount && body_pos_arr[sweep[j]].x - radius_arr[sweep[j]] <= x_max; ++j) {
+            const int   jb    = sweep[j];
+            const float reach = radius_arr[ib] + radius_arr[jb];
+            if ((ib < _sourceCount || jb < _sourceCount) && glm::distance2(body_pos_arr[ib], body_pos_arr[jb]) < reach * reach) {
+                const int ig = findGroup(ib);
+                const int jg = findGroup(jb);
+                group_arr[std::max(ig, jg)] = std::min(ig, jg);
+                touching = true;
+            }
+        }
+    }
+    if (!touching) {
+        return;
+    }
+
+    // The heaviest body of each group survives, the first one of equal masses.
+    vector<int> survivor_arr(bodyCount, -1);
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        int& survivor = survivor_arr[findGroup(ib)];
+        if (survivor < 0 || body_mass_arr[ib] > body_mass_arr[survivor]) {
+            survivor = ib;
+        }
+    }
+
+    struct GroupSums {
+        float energy = 0.0f;
+        vec3  momentum{};
+        vec3  accelPrevMoment{};
+        vec3  accelMoment{};
+        int   memberCount = 0;
+    };
+    vector<GroupSums> sums_arr(bodyCount);
+    vector<int>       keptBodies;
+    keptBodies.reserve(bodyCount);
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        const int   group  = findGroup(ib);
+        const float weight = body_mass_arr[ib] / std::sqrt(1.0f - glm::length2(body_vel_arr[ib]) * LightSpeedInvSq);
+
+        GroupSums& sums = sums_arr[group];
+        sums.energy += weight;
+        sums.momentum += weight * body_vel_arr[ib];
+        sums.accelPrevMoment += weight * body_accel_prev_arr[ib];
+        sums.accelMoment += weight * body_accel_arr[ib];
+        ++sums.memberCount;
+
+        if (survivor_arr[group] == ib) {
+            keptBodies.push_back(ib);
+        }
+    }
+
+    for (const int ib : keptBodies) {
+        const GroupSums& sums = sums_arr[findGroup(ib)];
+        if (sums.memberCount > 1) {
+            body_vel_arr[ib]        = sums.momentum / sums.energy;
+            body_mass_arr[ib]       = std::sqrt(std::max(sums.energy * sums.energy - glm::length2(sums.momentum) * LightSpeedInvSq, 0.0f));
+            body_accel_prev_arr[ib] = sums.accelPrevMoment / sums.energy;
+            body_accel_arr[ib]      = sums.accelMoment / sums.energy;
+        }
+    }
+
+    _mergeCount += bodyCount - (int)keptBodies.size();
+    compactBodies(keptBodies);
+}
+
+// Drops the bodies which are not kept, with all their state: the history rows, the entries of the light intersection cache and
+// the members of the octree. The kept bodies move forward in place, in their order, along with their rows and entries: as each
+// moves to an index not past its own, a forward pass over each array never overwrites what it has yet to read. The crossings
+// shared by the tiles of the coherent search get searched anew, as the tiles hold other targets now.
+//
+void NBodySim::compactBodies(std::span<const int> keptBodies)
+{
+    const int  bodyCount   = (int)keptBodies.size();
+    const int  sourceCount = (int)(std::ranges::lower_bound(keptBodies, _sourceCount) - keptBodies.begin());
+    const int  tileCount   = (bodyCount + ExactTileSize - 1) / ExactTileSize;
+    const auto keptSources = keptBodies.first(sourceCount);
+
+    // The entries move in the order of their new places, read through `interCacheEntry` from the old ones. The lanes past the
+    // last body stay cold.
+    if (_histInterMat.size().y > 0) {
+        const LightIntersectCacheEntry coldEntry{(uint16_t)((_recordIdx + 1) & 0xffff), 0};
+        for (int tile = 0; tile < tileCount; ++tile) {
+            for (int is = 0; is < sourceCount; ++is) {
+                const auto row = _histInterMat.row(tile * sourceCount + is);
+                for (int lane = 0; lane < ExactTileSize; ++lane) {
+                    const int it = tile * ExactTileSize + lane;
+                    row[lane]    = (it < bodyCount) ? interCacheEntry(keptBodies[it], keptSources[is]) : coldEntry;
+                }
+            }
+        }
+        _histInterMat.reset({ExactTileSize, tileCount * sourceCount});
+    }
+
+    if (_tileCrossingMat.size().y > 0) {
+        _tileCrossingMat.reset({sourceCount, tileCount}, TileCrossing{.recordIdx = -1});
+    }
+
+    // The spare row of the compressed history stays last.
+    const auto keepRows = [&]<typename T>(RaggedMatrix<T>& mat) {
+        if (mat.rowCount() == 0) {
+            return;
+        }
+        vector<int> rows(keptSources.begin(), keptSources.end());
+        for (int ir = _sourceCount; ir < mat.rowCount(); ++ir) {
+            rows.push_back(ir);
+        }
+        mat.keepRows(rows);
+    };
+    const auto keepElements = [&]<typename T>(vector<T>& arr) {
+        if (!arr.empty()) {
+            for (int is = 0; is < sourceCount; ++is) {
+                arr[is] = arr[keptSources[is]];
+            }
+            arr.resize(sourceCount);
+        }
+    };
+
+    keepRows(_histPosMat);
+    keepRows(_histPackedMat);
+    keepRows(_histVelMat);
+    keepElements(_histFirstLevelArr);
+    keepElements(_histAnchorArr);
+    keepElements(_histStagePosArr);
+    keepElements(_histStageVelArr);
 
-    _bodies             = std::move(bodies);
-    const int bodyCount = (int)_bodies.size();
+    _bodies.keep(keptBodies);
+    std::ranges::fill(_bodyIdxArr, -1);
+    for (int ib = 0; ib < bodyCount; ++ib) {
+        _bodyIdArr[ib]              = _bodyIdArr[keptBodies[ib]];
+        _bodyIdxArr[_bodyIdArr[ib]] = ib;
+    }
+    _bodyIdArr.resize(bodyCount);
+    _sourceCount = sourceCount;
+    ++_reorderCount;
+
+    if (_octree) {
+        _octree->rebuild(*this);
+    }
+}
 
-    _histPosMat.reset({(int)MaxRecordCount, bodyCount}, vec3{});
-    _histInterMat.reset({bodyCount, bodyCount}, LightIntersectCacheEntry{0, 0.0f});
+// Removes the bodies which escape, as in `escapeRadius`, with all their state as in `compactBodies`. The escaped sources are
+// kept for their far field with `keepEscapedMass`.
+//
+void NBodySim::removeEscapers()
+{
+    const auto body_pos_arr  = _bodies.field<&Body::pos>();
+    const auto body_vel_arr  = _bodies.field<&Body::vel>();
+    const auto body_mass_arr = _bodies.field<&Body::mass>();
+    const int  bodyCount     = _bodies.size();
+    const Body center        = massCenter();
+    if (center.mass <= 0.0f) {
+        return;
+    }
 
+    vector<int> keptBodies;
+    keptBodies.reserve(bodyCount);
     for (int ib = 0; ib < bodyCount; ++ib) {
-        _histPosMat({0, ib}) = _bodies[ib].pos;
+        const vec3  rel_pos = body_pos_arr[ib] - center.pos;
+        const vec3  rel_vel = body_vel_arr[ib] - center.vel;
+        const float dist    = glm::length(rel_pos);
+        if (dist <= _escapeRadius || glm::dot(rel_pos, rel_vel) <= 0.0f || 0.5f * glm::length2(rel_vel) <= GravConst * (center.mass - body_mass_arr[ib]) / dist) {
+            keptBodies.push_back(ib);
+            continue;
+        }
+
+        if (ib < _sourceCount) {
+            _escapedMass += body_mass_arr[ib];
+            if (_keepEscapedMass) {
+                _escapedArr.push_back(Body{.pos = body_pos_arr[ib], .vel = body_vel_arr[ib], .mass = body_mass_arr[ib]});
+            }
+        }
     }
+    if ((int)keptBodies.size() == bodyCount) {
+        return;
+    }
+
+    _escapeCount += bodyCount - (int)keptBodies.size();
+    compactBodies(keptBodies);
 }
 
-void NBodySim::step(float dt)
+// Adds the attraction of the escaped sources at the center of mass to all the bodies. Each escaped source moves at a constant
+// velocity, so its retarded position is the smaller root of the quadratic of `findAnalyticRetardedPos` without the acceleration,
+// exact along its straight world line. The Newtonian solver takes the current positions.
+//
+void NBodySim::applyEscapedPull()
 {
-    dt = std::min(dt, 0.01f);
-    dt = std::max(dt, 0.0001f);
+    const vec3 center = massCenter().pos;
 
-    // Compute all-to-all accelerations between bodies for the current/last frame.
-    //
-    const int bodyCount = (int)_bodies.size();
-    if (bodyCount == 0) {
-        return;
+    vec3 pull{};
+    for (const Body& escaped : _escapedArr) {
+        vec3 sb_pos = escaped.pos;
+        if (_forceSolver != ForceSolver::Newtonian) {
+            const vec3  sep   = center - escaped.pos;
+            const float dist2 = glm::length2(sep);
+            const float lin   = LightSpeedSq - 2.0f * glm::dot(sep, escaped.vel);
+            const float disc  = lin * lin - 4.0f * glm::length2(escaped.vel) * dist2;
+            if (lin > 0.0f && disc >= 0.0f) {
+                sb_pos -= escaped.vel * (2.0f * dist2 / (lin + std::sqrt(disc)));
+            }
+        }
+        pull += gravAccel(center, sb_pos, escaped.mass);
+    }
+
+    for (vec3& accel : _bodies.field<&Body::accel>()) {
+        accel += pull;
+    }
+}
+
+// The center of mass of the bodies and its velocity, as a body of their total mass.
+//
+NBodySim::Body NBodySim::massCenter() const
+{
+    const auto body_pos_arr  = _bodies.field<&Body::pos>();
+    const auto body_vel_arr  = _bodies.field<&Body::vel>();
+    const auto body_mass_arr = _bodies.field<&Body::mass>();
+
+    Body center{};
+    for (int ib = 0; ib < _bodies.size(); ++ib) {
+        center.pos += body_mass_arr[ib] * body_pos_arr[ib];
+        center.vel += body_mass_arr[ib] * body_vel_arr[ib];
+        center.mass += body_mass_arr[ib];
+    }
+    if (center.mass > 0.0f) {
+        center.pos /= center.mass;
+        center.vel /= center.mass;
+    }
+    return center;
+}
+
+// Compares the freshly computed accelerations of evenly spread bodies against the exact solution.
+//
+NBodySim::ForceErrorStats NBodySim::measureForceError(int sampleCount) const
+{
+    ForceErrorStats stats{};
+
+    const int bodyCount = _bodies.size();
+    if (bodyCount == 0 || sampleCount <= 0 || (_forceSolver != ForceSolver::Newtonian && !keepsHistory())) {
+        return stats;
+    }
+
+    double    sumRelErrorSq = 0.0;
+    const int stride        = std::max(1, bodyCount / sampleCount);
+    for (int ib = 0; ib < bodyCount && stats.sampleCount < sampleCount; ib += stride) {
+        const vec3  exactAccel = (_forceSolver == ForceSolver::Newtonian) ? computeNewtonianGravAccel(ib) : computeExactGravAccel(ib);
+        const float relError   = glm::length(_bodies.field<&Body::accel>()[ib] - exactAccel) / std::max(glm::length(exactAccel), 1e-20f);
+
+        sumRelErrorSq += (double)relError * relError;
+        stats.maxRelError = std::max(stats.maxRelError, relError);
+        ++stats.sampleCount;
+    }
+    stats.rmsRelError = (float)std::sqrt(sumRelErrorSq / stats.sampleCount);
+
+    return stats;
+}
+
+// The exhaustive scan walks the chain of the records back from the newest one, whose weight in the light-cone criterion is never
+// positive, to the first one whose weight is not negative: the older end of the segment holding the newest crossing.
+//
+NBodySim::RetardedSearchStats NBodySim::measureRetardedSearch(int sampleCount) const
+{
+    RetardedSearchStats stats{};
+
+    const int bodyCount = _bodies.size();
+    if (bodyCount < 2 || sampleCount <= 0 || !keepsHistory()) {
+        return stats;
     }
 
-    for (int ib1 = 0; ib1 < bodyCount; ++ib1) {
-        Body& b1     = _bodies[ib1];
-        b1.accelPrev = std::exchange(b1.accel, vec3{});
+    const auto body_pos_arr = _bodies.field<&Body::pos>();
+    const int  rec_start    = oldestRecordIdx();
+
+    int64_t   stepCount     = 0;
+    int       mismatchCount = 0;
+    int       targetCount   = 0;
+    const int stride        = std::max(1, bodyCount / sampleCount);
+    for (int it = 0; it < bodyCount && targetCount < sampleCount; it += stride, ++targetCount) {
+        const vec3& target_pos = body_pos_arr[it];
+        for (int is = 0; is < _sourceCount; ++is) {
+            if (is == it) {
+                continue;
+            }
+
+            int   hist_record_idx = 0;
+            float hist_alpha      = 0.0f;
+            if (_forceSolver == ForceSolver::Exact && _exactSearch == ExactSearch::Coherent) {
+                const TileCrossing& tile_crossing = _tileCrossingMat({is, it / ExactTileSize});
+                hist_record_idx                   = (tile_crossing.recordIdx >= 0) ? guessTileRecordIdx(tile_crossing, target_pos) : guessCachedRecordIdx(glm::distance2(target_pos, body_pos_arr[is]));
+            } else if (_forceSolver == ForceSolver::Exact && _exactSearch == ExactSearch::Cacheless) {
+                hist_record_idx = guessCachedRecordIdx(glm::distance2(target_pos, body_pos_arr[is]));
+            } else if (_forceSolver == ForceSolver::Exact) {
+                decodeCacheEntry(interCacheEntry(it, is), hist_record_idx, hist_alpha);
+                if (hist_record_idx < rec_start) {
+                    hist_record_idx = guessCachedRecordIdx(glm::distance2(target_pos, body_pos_arr[is]));
+                }
+            } else {
+                hist_record_idx = guessRecordIdx(lightDelay(glm::distance2(target_pos, body_pos_arr[is])), _histLevelCount);
+            }
+
+            int  searchStepCount = 0;
+            vec3 sb_pos{};
+            const bool found = withHistRow(is, [&](const auto& s_pos_arr) {
+                return findRetardedPosIn(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, _histLevelCount, &searchStepCount);
+            });
+
+            const int first_level  = histFirstLevel(is);
+            int       crossing_idx = _recordIdx;
+            withHistRow(is, [&](const auto& s_pos_arr) {
+                while (crossing_idx >= rec_start) {
+                    const int slot = histRecordSlot(crossing_idx, first_level);
+                    if (LightSpeedSq * (_time - _histTimeArr[slot]) - glm::distance2(target_pos, s_pos_arr[slot]) >= 0.0f) {
+                        break;
+                    }
+                    const int level = histRecordLevel(crossing_idx, _histLevelCount, first_level);
+                    crossing_idx    = (crossing_idx > levelOldestRecordIdx(level, first_level)) ? crossing_idx - (1 << level) : (crossing_idx - 1) & -(1 << std::max(level + 1, first_level));
+                }
+            });
+            // A crossing right on a record ends the segment before it as well as it starts the next one: the search stops at the former,
+            // the scan at the latter.
+            const bool crossed  = crossing_idx >= rec_start && crossing_idx < _recordIdx;
+            const int  s0_level = found ? histRecordLevel(hist_record_idx, _histLevelCount, first_level) : 0;
+            const bool same     = found && (hist_record_idx == crossing_idx || histSegmentEnd(hist_record_idx, s0_level, first_level) == crossing_idx);
+            mismatchCount += (found != crossed || (found && !same));
+
+            if (found) {
+                const int    s1_idx       = histSegmentEnd(hist_record_idx, s0_level, first_level);
+                const double s0_time      = _histTimeArr[histLevelSlot(s0_level, hist_record_idx)];
+                const double s1_time      = _histTimeArr[histRecordSlot(s1_idx, first_level)];
+                const double sb_past_time = _time - (s0_time + (s1_time - s0_time) * hist_alpha);
+                const double sb_dist2     = glm::distance2(target_pos, sb_pos);
+                const float  residual     = (float)(std::abs(LightSpeedSq * sb_past_time - sb_dist2) / std::max(sb_dist2, 1e-20));
+                stats.maxResidual         = std::max(stats.maxResidual, residual);
+            }
 
-        for (int ib2 = 0; ib2 < ib1; ++ib2) {
-            applyGravAccel(ib1, ib2);
-            applyGravAccel(ib2, ib1);
+            stepCount += searchStepCount;
+            stats.maxStepCount = std::max(stats.maxStepCount, searchStepCount);
+            ++stats.sampleCount;
         }
     }
+    if (stats.sampleCount == 0) {
+        return stats;
+    }
+    stats.meanStepCount    = (float)((double)stepCount / stats.sampleCount);
+    stats.mismatchFraction = (float)mismatchCount / stats.sampleCount;
 
-    // Progress the counters to the next simulation frame.
-    //
-    ++_step;
-    if (_step % RecordStepInterval == 1) {
-        ++_recordIdx;
+    return stats;
+}
+
+// Sums the accelerations of all the pairs of a source and another body, each with its own cached light-cone intersection, with the
+// one shared by its tile of targets in the coherent search, or with none in the cacheless search. The vectorized kernels process several
+// targets against each source at once; the scalar loop is the reference.
+// The threads take chunks of tiles of targets, as each target owns its acceleration and its cache entries. The sources out of
+// the causal horizon of a whole tile are skipped at once, and those out of the horizon of a single target in `applyGravAccel`.
+//
+void NBodySim::applyExactGravAccels()
+{
+    static_assert(sizeof(vec3) == 3 * sizeof(float));
+    static_assert(sizeof(LightIntersectCacheEntry) == sizeof(RetardedGravityCacheEntry));
+    static_assert(offsetof(LightIntersectCacheEntry, alphaFixed) == offsetof(RetardedGravityCacheEntry, alphaFixed));
+    static_assert(std::endian::native == std::endian::little);
+    static_assert(sizeof(PackedHistPos) == 3 * sizeof(int16_t));
+    static_assert(sizeof(HistAnchor) == sizeof(RetardedGravityHistAnchor));
+    static_assert(offsetof(HistAnchor, scale) == offsetof(RetardedGravityHistAnchor, scale));
+    static_assert(sizeof(TileCrossing) == sizeof(RetardedGravityCrossing));
+    static_assert(offsetof(TileCrossing, recordIdx) == offsetof(RetardedGravityCrossing, recordIdx));
+    static_assert(sizeof(TileReach) == sizeof(RetardedGravityTileReach));
+    static_assert(ExactTileSize == RetardedGravityTileSize);
+    static_assert(HermiteNewtonSteps == RetardedGravityHermiteSteps);
+
+    const int bodyCount  = _bodies.size();
+    const int rec_start  = oldestRecordIdx();
+    const int blockSize  = exactBlockSize();
+    const int tileCount  = (bodyCount + ExactTileSize - 1) / ExactTileSize;
+    const int chunkTiles = _sourceBlocking ? std::clamp(tileCount / (4 * threadCount()), 1, ExactMaxChunkTiles) : 1;
+
+    updateRecordGuesses();
+    updateHorizonSkips();
+    if (_exactSearch == ExactSearch::Coherent) {
+        updateTileCrossings();
     }
 
-    _time += dt;
-    _histTimeArr[_recordIdx % MaxRecordCount] = _time;
+    std::array<int, MaxHistLevelCount> levelRecStartArr{};
+    for (int level = 0; level < _histLevelCount; ++level) {
+        levelRecStartArr[level] = levelOldestRecordIdx(level);
+    }
 
-    // Update the positions and velocities of all bodies.
-    //
-    for (int ib = 0; ib < bodyCount; ++ib) {
-        Body& body = _bodies[ib];
+    int (*kernel)(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd) = nullptr;
+#if RETARDED_GRAVITY_KERNEL_X86
+    switch (_simdIsa) {
+        case SimdIsa::Scalar:
+            break;
+        case SimdIsa::Sse4:
+            kernel = &applyRetardedGravitySse4;
+            break;
+        case SimdIsa::Avx2:
+            kernel = &applyRetardedGravityAvx2;
+            break;
+        case SimdIsa::Avx512:
+            kernel = &applyRetardedGravityAvx512;
+            break;
+    }
+#endif
+
+    // The scalar loop follows the blocks and the tiles of the kernels. Each target still sums its sources in their order.
+    if (!kernel) {
+        _threadPool->parallelFor(bodyCount, chunkTiles * ExactTileSize, [&](int begin, int end) {
+            int outOfWindowCount = 0;
+            for (int blockBegin = 0; blockBegin < _sourceCount; blockBegin += blockSize) {
+                for (int tileBegin = begin; tileBegin < end; tileBegin += ExactTileSize) {
+                    const int                 tileEnd        = std::min(tileBegin + ExactTileSize, end);
+                    const int                 tile           = tileBegin / ExactTileSize;
+                    const uint8_t* const      tile_skip      = (_horizonSkipMat.size().y > 0) ? _horizonSkipMat.row(tile).data() : nullptr;
+                    const bool                tile_reach     = !_tileReachArr.empty();
+                    const TileCrossing* const tile_crossings = (_exactSearch == ExactSearch::Coherent) ? _tileCrossingMat.row(tile).data() : nullptr;
+                    for (int is = blockBegin; is < std::min(blockBegin + blockSize, _sourceCount); ++is) {
+                        if ((tile_skip && tile_skip[is]) || (tile_reach && outOfTileReach(tile, _bodies.field<&Body::pos>()[is]))) {
+                            for (int it = tileBegin; it < tileEnd && _exactSearch == ExactSearch::Cached; ++it) {
+                                interCacheEntry(it, is).recordTag = (uint16_t)(rec_start & 0xffff);
+                            }
+                            outOfWindowCount += (rec_start > 0) ? tileEnd - tileBegin : 0;
+                            continue;
+                        }
+                        for (int it = tileBegin; it < tileEnd; ++it) {
+                            if (it != is) {
+                                applyGravAccel(it, is, tile_crossings ? &tile_crossings[is] : nullptr);
+                            }
+                        }
+                    }
+                }
+            }
+            if (outOfWindowCount > 0) {
+                _outOfWindowCounter.fetch_add(outOfWindowCount, std::memory_order_relaxed);
+            }
+        });
+        return;
+    }
+
+    const RetardedGravityKernelArgs args{
+        .sourceCount    = _sourceCount,
+        .blockSize      = blockSize,
+        .bodyPos        = &_bodies.field<&Body::pos>().data()->x,
+        .bodyMass       = _bodies.field<&Body::mass>().data(),
+        .bodyAccel      = &_bodies.field<&Body::accel>().data()->x,
+        .histPos        = (_historyEncoding == HistoryEncoding::Full) ? &_histPosMat.row(0).data()->x : nullptr,
+        .histStage      = _histStagePosArr.empty() ? nullptr : &_histStagePosArr.data()->x,
+        .histVel        = _hermiteHistory ? &_histVelMat.row(0).data()->x : nullptr,
+        .histStageVel   = _hermiteHistory ? &_histStageVelArr.data()->x : nullptr,
+        .histPacked     = (_historyEncoding == HistoryEncoding::Fixed16) ? &_histPackedMat.row(0).data()->x : nullptr,
+        .histAnchor     = reinterpret_cast<const RetardedGravityHistAnchor*>(_histAnchorArr.data()),
+        .histRowBegin   = (_historyEncoding == HistoryEncoding::Fixed16) ? _histPackedMat.rowBegins() : _histPosMat.rowBegins(),
+        .histFirstLevel = _histFirstLevelArr.empty() ? nullptr : _histFirstLevelArr.data(),
+        .histTime       = _histTimeArr.data(),
+        .interCache     = (_exactSearch == ExactSearch::Cached) ? reinterpret_cast<RetardedGravityCacheEntry*>(_histInterMat.row(0).data()) : nullptr,
+        .tileCrossing   = (_exactSearch == ExactSearch::Coherent) ? reinterpret_cast<const RetardedGravityCrossing*>(_tileCrossingMat.row(0).data()) : nullptr,
+        .recordCount    = _recordCount,
+        .levelCount     = _histLevelCount,
+        .levelRecStart  = levelRecStartArr.data(),
+        .recStart       = rec_start,
+        .recEnd         = _recordIdx + 1,
+        .recordGuess    = _recordGuessArr.data(),
+        .guessBinCount  = RecordGuessBinCount,
+        .horizonSkip    = (_horizonSkipMat.size().y > 0) ? _horizonSkipMat.row(0).data() : nullptr,
+        .tileReach      = _tileReachArr.empty() ? nullptr : reinterpret_cast<const RetardedGravityTileReach*>(_tileReachArr.data()),
+        .time           = _time,
+        .lightSpeedSq   = LightSpeedSq,
+        .gravSoftening  = GravSoftening,
+        .maxSearchJump  = MaxSearchJump,
+        .guessScale     = _recordGuessScale,
+        .horizonReach2  = _horizonReach2,
+    };
+    _threadPool->parallelFor(bodyCount, chunkTiles * ExactTileSize, [&](int begin, int end) {
+        if (const int outOfWindowCount = kernel(args, begin, end); outOfWindowCount > 0) {
+            _outOfWindowCounter.fetch_add(outOfWindowCount, std::memory_order_relaxed);
+        }
+    });
+}
+
+// The sources of a block, whose history rows fill `ExactBlockBytes`, on average with the adaptive sampling; all of them without
+// the blocking.
+//
+int NBodySim::exactBlockSize() const
+{
+    if (!_sourceBlocking) {
+        return std::max(1, _sourceCount);
+    }
+
+    int64_t slotCount = (int64_t)_histLevelCount * _recordCount * _sourceCount;
+    for (const int first_level : _histFirstLevelArr) {
+        slotCount -= first_level * _recordCount;
+    }
+    const int recordBytes = (int)(_historyEncoding == HistoryEncoding::Fixed16 ? sizeof(PackedHistPos) : sizeof(vec3)) + (_hermiteHistory ? (int)sizeof(vec3) : 0);
+    const int rowBytes    = (int)std::max<int64_t>(1, slotCount * recordBytes / std::max(1, _sourceCount));
+    return std::max(1, ExactBlockBytes / rowBytes);
+}
 
-        auto       vel0      = body.vel;
-        const auto vel0_len2 = glm::length2(body.vel);
-        if (vel0_len2 > MaxSpeedCap * MaxSpeedCap) {
-            vel0 *= MaxSpeedCap * MaxSpeedCap / vel0_len2;
+// In the cached search, the search starts from the cache entry of the pair and updates it. In the coherent one, it starts from
+// the guess from `tile_crossing`, and in the cacheless one from the guess from the current distance: the pair has no entry.
+//
+void NBodySim::applyGravAccel(int target_body_idx, int source_body_idx, const TileCrossing* tile_crossing)
+{
+    const vec3& target_pos = _bodies.field<&Body::pos>()[target_body_idx];
+    const float dist2      = glm::distance2(target_pos, _bodies.field<&Body::pos>()[source_body_idx]);
+    auto* const entry      = (_exactSearch == ExactSearch::Cached) ? &interCacheEntry(target_body_idx, source_body_idx) : nullptr;
+    const int   rec_start  = oldestRecordIdx();
+
+    // Out of the causal horizon: the entry ends at the oldest record, as the search would.
+    if (dist2 > _horizonReach2) {
+        if (entry) {
+            entry->recordTag = (uint16_t)(rec_start & 0xffff);
         }
-        assert(glm::length(vel0) < LightSpeed);
+        if (rec_start > 0) {
+            _outOfWindowCounter.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    int   hist_record_idx = 0;
+    float hist_alpha      = 0.0f;
+    if (entry) {
+        decodeCacheEntry(*entry, hist_record_idx, hist_alpha);
+    } else if (tile_crossing && tile_crossing->recordIdx >= 0) {
+        hist_record_idx = guessTileRecordIdx(*tile_crossing, target_pos);
+    } else {
+        hist_record_idx = -1;
+    }
+    if (hist_record_idx < rec_start) {
+        hist_record_idx = guessCachedRecordIdx(dist2);
+    }
+
+    vec3       sb_pos{};
+    const bool found = withHistRow(source_body_idx, [&](const auto& s_pos_arr) { return findRetardedPos(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, _histLevelCount); });
+    if (entry) {
+        *entry = encodeCacheEntry(hist_record_idx, hist_alpha);
+    }
+    if (!found) {
+        return;
+    }
+
+    _bodies.field<&Body::accel>()[target_body_idx] += gravAccel(target_pos, sb_pos, _bodies.field<&Body::mass>()[source_body_idx]);
+}
+
+// The record tag wraps around every 2^16 records, far beyond the history: resolving it against the newest record recovers
+// the index of any record in the history, while stale entries come out older than the history and get clamped by the search.
+// The vectorized kernels unpack and pack the entries with the same arithmetic.
+//
+void NBodySim::decodeCacheEntry(const LightIntersectCacheEntry& entry, int& hist_record_idx, float& hist_alpha) const
+{
+    hist_record_idx = _recordIdx - ((_recordIdx - entry.recordTag) & 0xffff);
+    hist_alpha      = (float)entry.alphaFixed / 65535.0f;
+}
+
+NBodySim::LightIntersectCacheEntry NBodySim::encodeCacheEntry(int hist_record_idx, float hist_alpha) const
+{
+    assert(hist_record_idx <= _recordIdx);
+    assert(hist_alpha >= 0.0f && hist_alpha <= 1.0f);
+    return {(uint16_t)(hist_record_idx & 0xffff), (uint16_t)(int)(hist_alpha * 65535.0f + 0.5f)};
+}
+
+// Sums the accelerations from all the other sources, searching the light-cone intersections from scratch.
+//
+vec3 NBodySim::computeExactGravAccel(int target_body_idx) const
+{
+    const vec3 target_pos = _bodies.field<&Body::pos>()[target_body_idx];
+    vec3       accel{};
 
-        auto       vel_delta      = 0.5f * (body.accelPrev + body.accel) * GravConst * dt;
-        const auto vel_delta_len2 = glm::length2(vel_delta);
-        if (vel_delta_len2 > MaxSpeedCap * MaxSpeedCap) {
-            vel_delta *= MaxSpeedCap * MaxSpeedCap / vel_delta_len2;
+    for (int is = 0; is < _sourceCount; ++is) {
+        if (is != target_body_idx) {
+            accel += computePairGravAccel(target_pos, is);
         }
-        assert(glm::length(vel_delta) < LightSpeed);
+    }
+
+    return accel;
+}
+
+// Computes the acceleration exerted by a single source without the light intersection cache.
+// The search starts from the record which would be crossed if the source was at rest.
+//
+vec3 NBodySim::computePairGravAccel(const vec3& target_pos, int source_body_idx) const
+{
+    int   hist_record_idx = guessRecordIdx(lightDelay(glm::distance2(target_pos, _bodies.field<&Body::pos>()[source_body_idx])), _histLevelCount);
+    float hist_alpha      = 0.0f;
+    vec3  sb_pos{};
+    if (!withHistRow(source_body_idx, [&](const auto& s_pos_arr) { return findRetardedPos(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, _histLevelCount); })) {
+        return vec3{};
+    }
+
+    return gravAccel(target_pos, sb_pos, _bodies.field<&Body::mass>()[source_body_idx]);
+}
 
-        if (glm::length2(vel_delta) > 0.0f) {
-            // Split vel0 into 2 components: colinear to vel_delta and orthogonal to it.
-            const auto vel0_coll = vel_delta * glm::dot(vel0, vel_delta) / glm::length2(vel_delta);
-            const auto vel0_orho = vel0 - vel0_coll;
+// Sums the attractions of all the sources at their current positions, with no history and no cache. The vectorized kernels
+// process several targets against each source at once; the scalar loop is the reference. The threads take chunks of targets.
+//
+void NBodySim::applyNewtonianGravAccels()
+{
+    const int bodyCount = _bodies.size();
 
-            body.vel = ((vel0_coll + vel_delta) + vel0_orho * std::sqrt(1.0f - glm::length2(vel_delta) * LightSpeedInvSq)) / (1.0f + glm::dot(vel_delta, vel0_coll) * LightSpeedInvSq);
+    void (*kernel)(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd) = nullptr;
+#if RETARDED_GRAVITY_KERNEL_X86
+    switch (_simdIsa) {
+        case SimdIsa::Scalar:
+            break;
+        case SimdIsa::Sse4:
+            kernel = &applyNewtonianGravitySse4;
+            break;
+        case SimdIsa::Avx2:
+            kernel = &applyNewtonianGravityAvx2;
+            break;
+        case SimdIsa::Avx512:
+            kernel = &applyNewtonianGravityAvx512;
+            break;
+    }
+#endif
 
-            const auto body_vel_len2 = glm::length2(body.vel);
-            if (body_vel_len2 > MaxSpeedCap * MaxSpeedCap) {
-                body.vel *= MaxSpeedCap * MaxSpeedCap / body_vel_len2;
+    if (!kernel) {
+        const auto body_accel_arr = _bodies.field<&Body::accel>();
+        _threadPool->parallelFor(bodyCount, NewtonianChunkSize, [&](int begin, int end) {
+            for (int it = begin; it < end; ++it) {
+                body_accel_arr[it] += computeNewtonianGravAccel(it);
             }
+        });
+        return;
+    }
+
+    const NewtonianGravityKernelArgs args{
+        .sourceCount   = _sourceCount,
+        .bodyPos       = &_bodies.field<&Body::pos>().data()->x,
+        .bodyMass      = _bodies.field<&Body::mass>().data(),
+        .bodyAccel     = &_bodies.field<&Body::accel>().data()->x,
+        .gravSoftening = GravSoftening,
+    };
+    _threadPool->parallelFor(bodyCount, NewtonianChunkSize, [&](int begin, int end) { kernel(args, begin, end); });
+}
+
+// Sums the accelerations from all the other sources at their current positions, in their order.
+//
+vec3 NBodySim::computeNewtonianGravAccel(int target_body_idx) const
+{
+    const auto body_pos_arr  = _bodies.field<&Body::pos>();
+    const auto body_mass_arr = _bodies.field<&Body::mass>();
+    vec3       accel{};
 
-            assert(glm::length(body.vel) < LightSpeed);
+    for (int is = 0; is < _sourceCount; ++is) {
+        if (is != target_body_idx) {
+            accel += gravAccel(body_pos_arr[target_body_idx], body_pos_arr[is], body_mass_arr[is]);
         }
+    }
+
+    return accel;
+}
+
+// Sums the attractions of all the sources at their retarded positions extrapolated from their current motion. The pairs whose
+// extrapolation is not accurate enough search the history instead, from the record of the extrapolated crossing. The vectorized
+// kernels process several targets against each source at once, and hand these pairs back one by one; the scalar loop is the
+// reference. The threads take chunks of targets.
+//
+void NBodySim::applyAnalyticGravAccels()
+{
+    const auto  body_pos_arr   = _bodies.field<&Body::pos>();
+    const auto  body_accel_arr = _bodies.field<&Body::accel>();
+    const int   bodyCount      = _bodies.size();
+    const bool  fallback       = keepsHistory();
+    const int   rec_start      = fallback ? oldestRecordIdx() : 0;
+    const float maxSpeedSq     = _analyticMaxSpeedRatio * _analyticMaxSpeedRatio * LightSpeedSq;
+    const float jerkBound      = 9.0f * _analyticErrorTolerance * _analyticErrorTolerance * LightSpeedSq;
+
+    AnalyticGravityKernelCounts (*kernel)(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd) = nullptr;
+#if RETARDED_GRAVITY_KERNEL_X86
+    switch (_simdIsa) {
+        case SimdIsa::Scalar:
+            break;
+        case SimdIsa::Sse4:
+            kernel = &applyAnalyticGravitySse4;
+            break;
+        case SimdIsa::Avx2:
+            kernel = &applyAnalyticGravityAvx2;
+            break;
+        case SimdIsa::Avx512:
+            kernel = &applyAnalyticGravityAvx512;
+            break;
+    }
+#endif
+
+    _analyticFallbackCount = 0;
+
+    if (!kernel) {
+        _threadPool->parallelFor(bodyCount, AnalyticChunkSize, [&](int begin, int end) {
+            AnalyticGravityKernelCounts counts{};
+            for (int it = begin; it < end; ++it) {
+                const vec3& target_pos = body_pos_arr[it];
+                vec3        accel      = body_accel_arr[it];
+
+                for (int is = 0; is < _sourceCount; ++is) {
+                    if (is == it) {
+                        continue;
+                    }
+
+                    float past_time = 0.0f;
+                    vec3  sb_pos{};
+                    if (!findAnalyticRetardedPos(target_pos, is, maxSpeedSq, jerkBound, past_time, sb_pos) && fallback) {
+                        ++counts.fallbackCount;
+                        vec3 pair_accel{};
+                        if (!searchGravAccel(target_pos, is, past_time, pair_accel) && rec_start > 0) {
+                            ++counts.outOfWindowCount;
+                        }
+                        accel += pair_accel;
+                        continue;
+                    }
+
+                    accel += gravAccel(target_pos, sb_pos, _bodies.field<&Body::mass>()[is]);
+                }
 
-        body.pos += dt * 0.5f * (vel0 + body.vel);
-        _histPosMat({_recordIdx % MaxRecordCount, ib}) = body.pos;
+                body_accel_arr[it] = accel;
+            }
+            _analyticFallbackCount.fetch_add(counts.fallbackCount, std::memory_order_relaxed);
+            _outOfWindowCounter.fetch_add(counts.outOfWindowCount, std::memory_order_relaxed);
+        });
+        return;
     }
+
+    const auto fallbackFn = [](const void* context, int target, int source, float pastTime, float* accel) {
+        const NBodySim& sim        = *static_cast<const NBodySim*>(context);
+        vec3            pair_accel = {};
+        const bool      found      = sim.searchGravAccel(sim._bodies.field<&Body::pos>()[target], source, pastTime, pair_accel);
+        std::copy_n(&pair_accel.x, 3, accel);
+        return found;
+    };
+
+    const AnalyticGravityKernelArgs args{
+        .sourceCount     = _sourceCount,
+        .bodyPos         = &body_pos_arr.data()->x,
+        .bodyVel         = &_bodies.field<&Body::vel>().data()->x,
+        .bodyAccelPrev   = &_bodies.field<&Body::accelPrev>().data()->x,
+        .bodyJerk        = _sourceJerkArr.data(),
+        .bodyMass        = _bodies.field<&Body::mass>().data(),
+        .bodyAccel       = &body_accel_arr.data()->x,
+        .fallback        = fallback ? +fallbackFn : nullptr,
+        .fallbackContext = this,
+        .recStart        = rec_start,
+        .lightSpeedSq    = LightSpeedSq,
+        .lightSpeedInvSq = LightSpeedInvSq,
+        .gravSoftening   = GravSoftening,
+        .maxSpeedSq      = maxSpeedSq,
+        .jerkBound       = jerkBound,
+    };
+    _threadPool->parallelFor(bodyCount, AnalyticChunkSize, [&](int begin, int end) {
+        const AnalyticGravityKernelCounts counts = kernel(args, begin, end);
+        _analyticFallbackCount.fetch_add(counts.fallbackCount, std::memory_order_relaxed);
+        _outOfWindowCounter.fetch_add(counts.outOfWindowCount, std::memory_order_relaxed);
+    });
 }
 
-void NBodySim::applyGravAccel(int target_body_idx, int source_body_idx)
+// Searches the history of a source for its crossing of the past light cone of the target, from the record at least `past_time`
+// old, and returns whether it found the crossing, with the acceleration it exerts on the target in `accel`.
+//
+bool NBodySim::searchGravAccel(const vec3& target_pos, int source_body_idx, float past_time, vec3& accel) const
 {
-    const int rec_start = std::max(0, (_recordIdx - (MaxRecordCount - 1)));
-    const int rec_end   = _recordIdx + 1;
-    assert(rec_end > rec_start);
+    int   hist_record_idx = guessRecordIdx(past_time, _histLevelCount);
+    float hist_alpha      = 0.0f;
+    vec3  sb_pos{};
+    if (!withHistRow(source_body_idx, [&](const auto& s_pos_arr) { return findRetardedPos(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, _histLevelCount); })) {
+        return false;
+    }
+
+    accel = gravAccel(target_pos, sb_pos, _bodies.field<&Body::mass>()[source_body_idx]);
+    return true;
+}
+
+// The jerk is taken before the accelerations of the last step move to the previous ones, as the difference between the two.
+//
+void NBodySim::updateSourceJerks()
+{
+    const auto body_accel_prev_arr = _bodies.field<&Body::accelPrev>();
+    const auto body_accel_arr      = _bodies.field<&Body::accel>();
+
+    _sourceJerkArr.resize(_sourceCount);
+    for (int ib = 0; ib < _sourceCount; ++ib) {
+        _sourceJerkArr[ib] = glm::length(body_accel_arr[ib] - body_accel_prev_arr[ib]) / _stepDt;
+    }
+}
+
+// The world line of the source is extrapolated back by its Taylor expansion: x(τ) = p − vτ + ½aτ², with the acceleration of the
+// last step. The crossing follows the light-cone criterion of `findRetardedPos`: c² · τ = |d + vτ − ½aτ²|², with `d` the separation
+// of the target from the current position of the source. Dropping the terms of the third order and higher in τ leaves a quadratic,
+// exact for a source moving at a constant velocity, whose smaller root is the most recent crossing; a Newton step on the whole
+// criterion then takes the acceleration into account.
+// The jerk of the source moves it by about |j|τ³/6 off the extrapolated world line, which tilts and scales the force by up to about
+// twice that relative to the distance c√τ: the estimated error. Its bound squared is `jerkBound` ≥ j²τ⁵, i.e. 9 · tolerance² · c².
+// Returns false if the error exceeds it, or if the source is faster than √`maxSpeedSq` for the expansion; `past_time` and `sb_pos`
+// are then still estimated, if only by the current position of the source. The vectorized kernels follow the same arithmetic.
+//
+bool NBodySim::findAnalyticRetardedPos(const vec3& target_pos, int source_body_idx, float maxSpeedSq, float jerkBound, float& past_time, vec3& sb_pos) const
+{
+    const vec3& s_pos   = _bodies.field<&Body::pos>()[source_body_idx];
+    const vec3& s_vel   = _bodies.field<&Body::vel>()[source_body_idx];
+    const vec3& s_accel = _bodies.field<&Body::accelPrev>()[source_body_idx];
+
+    const vec3  sep    = target_pos - s_pos;
+    const float dist2  = glm::length2(sep);
+    const float speed2 = glm::length2(s_vel);
+    const float quad   = speed2 - glm::dot(sep, s_accel);
+    const float lin    = LightSpeedSq - 2.0f * glm::dot(sep, s_vel);
+    const float disc   = lin * lin - 4.0f * quad * dist2;
 
-    auto&       target_body = _bodies[target_body_idx];
-    const auto& source_body = _bodies[source_body_idx];
-    const auto  s_pos_arr   = _histPosMat.row(source_body_idx);
+    past_time = lightDelay(dist2);
+    sb_pos    = s_pos;
+    if (speed2 > maxSpeedSq || lin <= 0.0f || disc < 0.0f) {
+        return false;
+    }
+
+    float tau = 2.0f * dist2 / (lin + std::sqrt(disc));
+    const vec3  x      = sep + s_vel * tau - 0.5f * s_accel * tau * tau;
+    const vec3  x_rate = s_vel - s_accel * tau;
+    const float slope  = LightSpeedSq - 2.0f * glm::dot(x, x_rate);
+    if (slope > 0.0f) {
+        tau -= (LightSpeedSq * tau - glm::length2(x)) / slope;
+    }
+
+    past_time = tau;
+    sb_pos    = s_pos - s_vel * tau + 0.5f * s_accel * tau * tau;
+
+    const float jerk = _sourceJerkArr[source_body_idx];
+    return jerk * jerk * tau * tau * tau * tau * tau <= jerkBound;
+}
+
+bool NBodySim::findRetardedPos(const vec3& target_pos, std::span<const vec3> s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count) const
+{
+    return findRetardedPosIn(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, level_count);
+}
+
+// The compressed positions are decoded as the search reads them.
+//
+bool NBodySim::findRetardedPos(const vec3& target_pos, const PackedHistRow& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count) const
+{
+    return findRetardedPosIn(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, level_count);
+}
+
+bool NBodySim::findRetardedPos(const vec3& target_pos, const StagedHistRow& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count) const
+{
+    return findRetardedPosIn(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, level_count);
+}
+
+bool NBodySim::findRetardedPos(const vec3& target_pos, const HermiteHistRow<PackedHistRow>& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count) const
+{
+    return findRetardedPosIn(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, level_count);
+}
+
+bool NBodySim::findRetardedPos(const vec3& target_pos, const HermiteHistRow<StagedHistRow>& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count) const
+{
+    return findRetardedPosIn(target_pos, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, level_count);
+}
 
-    auto& [hist_record_idx, hist_alpha] = _histInterMat({target_body_idx, source_body_idx});
+// The search walks the records of all the levels as a single chain: each record of a level older than the oldest record of
+// the previous level is followed by the next record of its level, or by that oldest record. A hint between the records
+// of a level, left by a level that has moved on since, is rounded down to the previous record. The chain of a body sampled
+// from a coarser level skips the finer ones, whose records it does not hold, but for the newest record, which is staged.
+//
+// The weight of the light-cone criterion, c² · t - d², falls from the older end of the segment holding the crossing to the newer
+// one. Along a segment, t is linear and d² quadratic in the segment parameter β, so the weight is a concave quadratic:
+//      w(β) = w0 + b β - |Δs|² β²,  with  b = c² (t1 - t0) + 2 (target - s0) · Δs  and  Δs = s1 - s0,
+// which has a single root in [0, 1] when w0 ≥ 0 ≥ w1. It is computed in the form free of cancellation for the sign of b.
+// Outside of the segment, the root of the chord through w0 and w1 tells how many segments to jump at once. Once the search
+// has seen records on both sides of the crossing, it bisects the records between them instead.
+//
+// A history with velocities refines the root of the chord with Newton steps along the cubic Hermite segment between the
+// records, and returns the position on that curve, so that sparser records keep the retarded positions close to the orbits.
+//
+template<typename HistRow> bool NBodySim::findRetardedPosIn(const vec3& target_pos, const HistRow& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count,
+                                                            int* search_step_count, bool count_out_of_window) const
+{
+    const int rec_start   = levelOldestRecordIdx(level_count - 1);
+    const int rec_end     = _recordIdx + 1;
+    const int first_level = histRowFirstLevel(s_pos_arr);
+    assert(rec_end > rec_start);
 
-    vec3  s0_pos{};
-    vec3  s1_pos{};
-    float beta{};
+    // The newest record known to be older than the crossing, and the oldest one known to be newer.
+    int bracket_lo = -1;
+    int bracket_hi = rec_end;
 
     while (true) {
-        int s0_idx = hist_record_idx;
-        if (s0_idx < rec_start) {
-            s0_idx          = rec_start;
-            hist_record_idx = s0_idx;
-            hist_alpha      = 0.0f;
+        if (search_step_count) {
+            ++*search_step_count;
         }
 
-        int s1_idx = s0_idx + 1;
+        int s0_idx = std::max(hist_record_idx, rec_start);
+
+        const int s0_level = histRecordLevel(s0_idx, level_count, first_level);
+        const int s0_step  = 1 << s0_level;
+        s0_idx -= s0_idx % s0_step;
+        hist_record_idx = s0_idx;
+
+        const int s1_idx = histSegmentEnd(s0_idx, s0_level, first_level);
         if (s1_idx >= rec_end) {
-            return;
+            return false;
         }
 
-        s0_pos = s_pos_arr[s0_idx % MaxRecordCount];
-        s1_pos = s_pos_arr[s1_idx % MaxRecordCount];
+        const int s0_slot = histLevelSlot(s0_level, s0_idx);
+        const int s1_slot = histLevelSlot(histRecordLevel(s1_idx, level_count, first_level), s1_idx);
 
-        const float s0_past_time = _time - _histTimeArr[s0_idx % MaxRecordCount];
-        const float s1_past_time = _time - _histTimeArr[s1_idx % MaxRecordCount];
+        const vec3 s0_pos = s_pos_arr[s0_slot];
+        const vec3 s1_pos = s_pos_arr[s1_slot];
+
+        const float s0_past_time = _time - _histTimeArr[s0_slot];
+        const float s1_past_time = _time - _histTimeArr[s1_slot];
         assert(s0_past_time >= s1_past_time);
 
-        const float alpha        = hist_alpha;
-        const vec3  sa_pos       = s0_pos + (s1_pos - s0_pos) * alpha;
-        const float sa_past_time = s0_past_time + (s1_past_time - s0_past_time) * alpha;
-        float       sa_dist2      = glm::distance2(target_body.pos, sa_pos);
-        const float sa_ct2        = LightSpeedSq * sa_past_time;
-        const float sa_weight    = sa_ct2 - sa_dist2;
-
-        if (sa_weight < 0.0f) {
-            float       s0_dist2   = glm::distance2(target_body.pos, s0_pos);
-            const float s0_ct2     = LightSpeedSq * s0_past_time;
-            const float s0_weight = s0_ct2 - s0_dist2;
-
-            if (s0_weight < 0.0f) {
-                if (s0_idx == rec_start) {
-                    return;
-                } else {
-                    --hist_record_idx;
-                    hist_alpha = 1.0f;
-                    continue;
+        const float s0_weight = LightSpeedSq * s0_past_time - glm::distance2(target_pos, s0_pos);
+        const float s1_weight = LightSpeedSq * s1_past_time - glm::distance2(target_pos, s1_pos);
+
+        if (s0_weight < 0.0f) {
+            // The crossing is older: step back, within the level or to the next one.
+            if (s0_idx == rec_start) {
+                if (rec_start > 0 && count_out_of_window) {
+                    _outOfWindowCounter.fetch_add(1, std::memory_order_relaxed);
                 }
+                return false;
+            }
+            bracket_hi = s0_idx;
+            if (bracket_lo >= 0) {
+                hist_record_idx = (bracket_lo + bracket_hi) / 2;
+            } else {
+                const float jump = (s1_weight < s0_weight) ? std::min(s0_weight / (s1_weight - s0_weight), MaxSearchJump) : 0.0f;
+                hist_record_idx  = s0_idx - (1 + (int)jump) * s0_step;
+            }
+            continue;
+        }
+
+        if (s1_weight > 0.0f) {
+            // The crossing is newer: step forward, without passing the newest segment.
+            bracket_lo = s1_idx;
+            if (bracket_hi < rec_end) {
+                hist_record_idx = (bracket_lo + bracket_hi) / 2;
             } else {
-                beta = (alpha * s0_weight - 1.0f * sa_weight) / (s0_weight - sa_weight + 0.00001f);
-                assert(std::isfinite(beta));
-                break;
+                const float jump = (s1_weight < s0_weight) ? std::min(s1_weight / (s0_weight - s1_weight), MaxSearchJump) : 0.0f;
+                hist_record_idx  = std::max(s1_idx, std::min(s1_idx + (int)jump * (s1_idx - s0_idx), rec_end - 2));
+            }
+            continue;
+        }
+
+        const vec3  seg_delta = s1_pos - s0_pos;
+        const float seg_len2  = glm::length2(seg_delta);
+        const float b         = LightSpeedSq * (s1_past_time - s0_past_time) + 2.0f * glm::dot(target_pos - s0_pos, seg_delta);
+        const float sqrt_disc = std::sqrt(b * b + 4.0f * seg_len2 * s0_weight);
+        const float beta      = (b > 0.0f) ? (b + sqrt_disc) / (2.0f * seg_len2 + 0.00001f) : 2.0f * s0_weight / (sqrt_disc - b + 0.00001f);
+
+        hist_alpha = std::clamp(beta, 0.0f, 1.0f);
+        sb_pos     = s0_pos + seg_delta * hist_alpha;
+
+        if constexpr (requires { s_pos_arr.vel(s0_slot); }) {
+            // The cubic Hermite segment through the positions and velocities of both records, in powers of α.
+            const float seg_time = s0_past_time - s1_past_time;
+            const vec3  tan0     = s_pos_arr.vel(s0_slot) * seg_time;
+            const vec3  tan1     = s_pos_arr.vel(s1_slot) * seg_time;
+            const vec3  coef2    = 3.0f * seg_delta - 2.0f * tan0 - tan1;
+            const vec3  coef3    = tan0 + tan1 - 2.0f * seg_delta;
+
+            for (int i = 0; i < HermiteNewtonSteps; ++i) {
+                const vec3  offset  = target_pos - (s0_pos + hist_alpha * (tan0 + hist_alpha * (coef2 + hist_alpha * coef3)));
+                const vec3  tangent = tan0 + hist_alpha * (2.0f * coef2 + 3.0f * hist_alpha * coef3);
+                const float weight  = LightSpeedSq * (s0_past_time - seg_time * hist_alpha) - glm::length2(offset);
+                const float slope   = 2.0f * glm::dot(offset, tangent) - LightSpeedSq * seg_time;
+                if (slope < 0.0f) {
+                    hist_alpha = std::clamp(hist_alpha - weight / slope, 0.0f, 1.0f);
+                }
             }
+            sb_pos = s0_pos + hist_alpha * (tan0 + hist_alpha * (coef2 + hist_alpha * coef3));
+        }
+        return true;
+    }
+}
+
+int NBodySim::histRecordLevel(int record_idx, int level_count, int first_level) const
+{
+    int level = 0;
+    while (level + 1 < level_count && record_idx < levelOldestRecordIdx(level, first_level)) {
+        ++level;
+    }
+    return level;
+}
 
+int NBodySim::guessRecordIdx(float pastTime, int level_count) const
+{
+    const float time = _time - pastTime;
+
+    // The finest level reaching back to `time`, or the coarsest one.
+    int level = 0;
+    while (level + 1 < level_count && _histTimeArr[histLevelSlot(level, levelOldestRecordIdx(level))] > time) {
+        ++level;
+    }
+
+    // The record times grow monotonically with the record index, so bisect the level for the last record not newer than `time`.
+    int lo = levelOldestRecordIdx(level) >> level;
+    int hi = _recordIdx >> level;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) / 2;
+        if (_histTimeArr[histLevelSlot(level, mid << level)] <= time) {
+            lo = mid;
         } else {
-            float       s1_dist2   = glm::distance2(target_body.pos, s1_pos);
-            const float s1_ct2     = LightSpeedSq * s1_past_time;
-            const float s1_weight = s1_dist2 - s1_ct2;
+            hi = mid - 1;
+        }
+    }
+    return lo << level;
+}
 
-            if (s1_weight < 0.0f) {
-                ++hist_record_idx;
-                hist_alpha = 0.0f;
-                continue;
+// A source seen from a target at distance `d` has been at least `d - MaxSpeedCap · T` away from it during the look-back `T` of the
+// history, while its signals have travelled at most `c · sqrt(T)` under the light-cone criterion of `findRetardedPos` (c² · t ≥ d²).
+// The targets of a tile are bounded by a sphere around the center of their box, so a source farther from it than the sum of
+// its radius and these reaches cannot have a record inside the light cone of any of them, nor a source farther than the reach
+// from a single target. The margin absorbs the rounding of the search, and the error bound of the compressed history widens
+// the reach. The cacheless search keeps only the spheres, and each tile tests the distance of each source as it sweeps them.
+//
+void NBodySim::updateHorizonSkips()
+{
+    constexpr float Margin = 1.001f;
+
+    const auto body_pos_arr = _bodies.field<&Body::pos>();
+    const int  bodyCount    = _bodies.size();
+    const int  tileCount    = (bodyCount + ExactTileSize - 1) / ExactTileSize;
+
+    _horizonSkipCount = 0;
+    if (!_horizonSkipping) {
+        _horizonReach2  = std::numeric_limits<float>::infinity();
+        _horizonSkipMat = Matrix<uint8_t>{};
+        _tileReachArr.clear();
+        return;
+    }
+
+    const float lookBack = historyLookBack();
+    const float reach    = LightSpeed * std::sqrt(lookBack) + MaxSpeedCap * lookBack + std::sqrt(3.0f) * historyErrorBound();
+    _horizonReach2       = (reach * Margin) * (reach * Margin);
+
+    const bool cacheless = _exactSearch == ExactSearch::Cacheless;
+    if (cacheless) {
+        _horizonSkipMat = Matrix<uint8_t>{};
+        _tileReachArr.resize(tileCount);
+    } else {
+        _horizonSkipMat.reset({_sourceCount, tileCount});
+        _tileReachArr.clear();
+    }
+
+    std::atomic<int64_t> skipCount = 0;
+    _threadPool->parallelFor(tileCount, 1, [&](int begin, int end) {
+        for (int tile = begin; tile < end; ++tile) {
+            const int tileBegin = tile * ExactTileSize;
+            const int tileEnd   = std::min(tileBegin + ExactTileSize, bodyCount);
+
+            vec3  center;
+            float radius;
+            tileBounds(tile, center, radius);
+            const float skip_dist = (radius + reach) * Margin;
+
+            int64_t tile_skips = 0;
+            if (cacheless) {
+                _tileReachArr[tile] = TileReach{center, skip_dist * skip_dist};
+                for (int is = 0; is < _sourceCount; ++is) {
+                    tile_skips += outOfTileReach(tile, body_pos_arr[is]) ? tileEnd - tileBegin : 0;
+                }
             } else {
-                beta = (alpha * s1_weight + 1.0f * sa_weight) / (sa_weight + s1_weight + 0.00001f);
-                assert(std::isfinite(beta));
-                break;
+                const auto skip_row = _horizonSkipMat.row(tile);
+                for (int is = 0; is < _sourceCount; ++is) {
+                    skip_row[is] = glm::distance2(center, body_pos_arr[is]) > skip_dist * skip_dist;
+                    tile_skips += skip_row[is] ? tileEnd - tileBegin : 0;
+                }
             }
+            skipCount.fetch_add(tile_skips, std::memory_order_relaxed);
         }
+    });
+    _horizonSkipCount = skipCount;
+}
+
+// The sphere around the center of the box of the targets of a tile.
+//
+void NBodySim::tileBounds(int tile, vec3& center, float& radius) const
+{
+    const auto body_pos_arr = _bodies.field<&Body::pos>();
+    const int  tileBegin    = tile * ExactTileSize;
+    const int  tileEnd      = std::min(tileBegin + ExactTileSize, (int)_bodies.size());
+
+    vec3 box_min = body_pos_arr[tileBegin];
+    vec3 box_max = body_pos_arr[tileBegin];
+    for (int it = tileBegin + 1; it < tileEnd; ++it) {
+        box_min = glm::min(box_min, body_pos_arr[it]);
+        box_max = glm::max(box_max, body_pos_arr[it]);
     }
+    center = 0.5f * (box_min + box_max);
+    radius = 0.5f * glm::distance(box_min, box_max);
+}
 
-    const vec3  sb_pos = s0_pos + (s1_pos - s0_pos) * beta;
-    const float distSq = glm::distance2(sb_pos, target_body.pos);
-    const vec3  attr   = (sb_pos - target_body.pos) / (distSq * std::sqrt(distSq) + 0.001f);
-    target_body.accel += attr * source_body.mass;
+// The shared searches start from the crossings of the previous step, and those without one from the guesses of the cold cache
+// entries. They do not count the pairs out of the history, as each target of the tile searches again from its own guess.
+// The sources out of the reach of a tile have no shared crossing.
+//
+void NBodySim::updateTileCrossings()
+{
+    const auto body_pos_arr = _bodies.field<&Body::pos>();
+    const int  bodyCount    = _bodies.size();
+    const int  tileCount    = (bodyCount + ExactTileSize - 1) / ExactTileSize;
+    const int  rec_start    = oldestRecordIdx();
 
-    hist_alpha = beta;
-    assert(hist_alpha >= 0.0f && hist_alpha <= 1.0f);
+    _tileCrossingMat.reset({_sourceCount, tileCount});
+    _threadPool->parallelFor(tileCount, 1, [&](int begin, int end) {
+        for (int tile = begin; tile < end; ++tile) {
+            vec3  center;
+            float radius;
+            tileBounds(tile, center, radius);
+
+            const uint8_t* const tile_skip      = _horizonSkipping ? _horizonSkipMat.row(tile).data() : nullptr;
+            const auto           tile_crossings = _tileCrossingMat.row(tile);
+            for (int is = 0; is < _sourceCount; ++is) {
+                TileCrossing& tile_crossing = tile_crossings[is];
+                if (tile_skip && tile_skip[is]) {
+                    tile_crossing.recordIdx = -1;
+                    continue;
+                }
+
+                int hist_record_idx = tile_crossing.recordIdx;
+                if (hist_record_idx < rec_start || hist_record_idx >= _recordIdx) {
+                    hist_record_idx = guessCachedRecordIdx(glm::distance2(center, body_pos_arr[is]));
+                }
+
+                float hist_alpha = 0.0f;
+                vec3  sb_pos{};
+                if (!withHistRow(is, [&](const auto& s_pos_arr) { return findRetardedPosIn(center, s_pos_arr, hist_record_idx, hist_alpha, sb_pos, _histLevelCount, nullptr, false); })) {
+                    tile_crossing.recordIdx = -1;
+                    continue;
+                }
+
+                // The segment of the crossing, as in `findRetardedPosIn`.
+                const int   first_level = histFirstLevel(is);
+                const int   s0_level    = histRecordLevel(hist_record_idx, _histLevelCount, first_level);
+                const int   s1_idx      = histSegmentEnd(hist_record_idx, s0_level, first_level);
+                const int   s0_slot     = histLevelSlot(s0_level, hist_record_idx);
+                const int   s1_slot     = histRecordSlot(s1_idx, first_level);
+                const float seg_time    = _histTimeArr[s1_slot] - _histTimeArr[s0_slot];
+                const vec3  seg_delta   = withHistRow(is, [&](const auto& s_pos_arr) { return s_pos_arr[s1_slot] - s_pos_arr[s0_slot]; });
+
+                tile_crossing.pos        = sb_pos;
+                tile_crossing.pastTime   = _time - (_histTimeArr[s0_slot] + seg_time * hist_alpha);
+                tile_crossing.vel        = -seg_delta / seg_time;
+                tile_crossing.recordRate = (float)(s1_idx - hist_record_idx) / seg_time;
+                tile_crossing.recordIdx  = hist_record_idx;
+                tile_crossing.recordPos  = (float)(s1_idx - hist_record_idx) * hist_alpha;
+            }
+        }
+    });
+}
+
+// The weight of the light-cone criterion of the target at the shared crossing, c² · t - d², changes at the rate c² + 2 (target - s) · v
+// with the past time t, where v is the velocity of the source backwards. The guess is clamped to the segments of the history.
+// The vectorized kernels guess with the same arithmetic.
+//
+int NBodySim::guessTileRecordIdx(const TileCrossing& tile_crossing, const vec3& target_pos) const
+{
+    const vec3  offset_pos = target_pos - tile_crossing.pos;
+    const float weight     = LightSpeedSq * tile_crossing.pastTime - glm::length2(offset_pos);
+    const float slope      = LightSpeedSq + 2.0f * glm::dot(offset_pos, tile_crossing.vel);
+    const float record_off = tile_crossing.recordPos + ((slope > 0.0f) ? weight / slope : 0.0f) * tile_crossing.recordRate;
+    const float min_off    = (float)(oldestRecordIdx() - tile_crossing.recordIdx);
+    const float max_off    = (float)(_recordIdx - 1 - tile_crossing.recordIdx);
+    return tile_crossing.recordIdx + (int)std::floor(std::max(min_off, std::min(record_off, max_off)));
+}
+
+// The bins split the look-back of the history evenly, and hold the record guessed for the shortest delay of each bin. The guesses
+// stop at the newest segment: a search starting from the newest record takes the crossing for newer than the history, while
+// the newest record is as old as the current time and never inside the light cone of another body.
+//
+void NBodySim::updateRecordGuesses()
+{
+    const float binTime = historyLookBack() / (float)(RecordGuessBinCount - 1);
+    _recordGuessScale   = (binTime > 0.0f) ? LightSpeedInvSq / binTime : 0.0f;
+
+    _recordGuessArr.resize(RecordGuessBinCount);
+    for (int bin = 0; bin < RecordGuessBinCount; ++bin) {
+        _recordGuessArr[bin] = std::min(guessRecordIdx((float)bin * binTime, _histLevelCount), _recordIdx - 1);
+    }
 }
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
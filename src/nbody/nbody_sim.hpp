@@ -16,20 +16,49 @@
 #pragma once
 
 #include "core/basic_types.hpp"
+#include "core/cpu_features.hpp"
 #include "core/matrix.hpp"
+#include "core/ragged_matrix.hpp"
+#include "core/soa_vector.hpp"
+#include "core/thread_pool.hpp"
+
+class RetardedFmm;
+class RetardedOctree;
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
 
 class NBodySim
 {
+    friend class RetardedFmm;
+    friend class RetardedOctree;
+
 public:
     const float LightSpeed         = 10.0f;
     const float LightSpeedSq       = LightSpeed * LightSpeed;
     const float LightSpeedInvSq    = 1.0f / LightSpeedSq;
     const float MaxSpeedCap        = 0.999 * LightSpeed;
     const float GravConst          = 1.0f;
-    const int   MaxRecordCount     = 512;
-    const int   RecordStepInterval = 16;
+    const int   MinRecordCount     = 64;
+    const int   MaxRecordCount     = 4096;
+
+    constexpr static const float GravSoftening = 0.001f;         // Added to the cubed distance of the attraction, to tame close encounters.
+    constexpr static const float BodyDensity   = 1.0f;           // The mass per unit of volume of the bodies, which sets their radii.
+    constexpr static const float HistMinScale  = 1.0f / 8192.0f;  // The finest grid of the compressed position history.
+    constexpr static const float MaxSearchJump = 4096.0f;         // The segments the search of the light-cone crossings may skip at once.
+
+    constexpr static const int   MaxHistLevelCount      = 8;     // The levels span at most 2^16 records, the range of the record tags of the cache.
+    constexpr static const int   HistDepthCheckInterval = 16;    // Records between the checks of the depth of the history against the size of the system.
+    constexpr static const int   RecordGuessBinCount    = 1024;  // Bins of the light delays across the history, for the cold entries of the light intersection cache.
+    constexpr static const float HistDepthMargin        = 1.5f;  // The look-back of the history, relative to the delay of the signals across the system.
+    constexpr static const int   HermiteNewtonSteps     = 2;     // Steps refining the crossing along the Hermite interpolation of a segment, from the linear one.
+
+    constexpr static const int ExactTileSize        = 256;      // Targets sweeping the sources together in the exact solver: a tile of the vectorized kernels.
+    constexpr static const int ExactMaxChunkTiles   = 8;        // Tiles per chunk of the parallel exact solver, which sweep the same blocks of sources.
+    constexpr static const int ExactBlockBytes      = 1 << 20;  // The history rows of a block of sources, sized to stay in the L2 cache while the tiles sweep it.
+    constexpr static const int BarnesHutChunkSize   = 64;       // Targets per chunk of the parallel Barnes-Hut solver.
+    constexpr static const int NewtonianChunkSize   = 64;       // Targets per chunk of the parallel Newtonian solver.
+    constexpr static const int AnalyticChunkSize    = 64;       // Targets per chunk of the parallel analytic solver.
+    constexpr static const int IntegrationChunkSize = 2048;     // Bodies per chunk of the parallel integration and history recording.
 
     struct Body {
         vec3  pos;
@@ -39,29 +68,574 @@ public:
         vec3  accel;
     };
 
+    // The bodies are stored as a structure of arrays, so that the force loops read only the positions and masses
+    // and write only the accelerations.
+    using BodyArray = SoaVector<&Body::pos, &Body::vel, &Body::mass, &Body::accelPrev, &Body::accel>;
+
+    // The light-cone crossing found for a pair of bodies in the previous step, where the search starts from in the next one.
+    // It is quantized to 4 bytes, as the cache of the exact solver holds one for each ordered pair of bodies.
+    //
     struct LightIntersectCacheEntry {
-        int   recordIdx;
-        float alpha;
+        uint16_t recordTag;   // The record index modulo 2^16, resolved as the nearest record not newer than the newest one.
+        uint16_t alphaFixed;  // The position of the crossing between the record and the next one, in units of 1/65535.
+    };
+
+    // The light-cone crossing of a source found for the center of a tile of targets in the coherent search of the exact solver,
+    // from which each target of the tile guesses its own crossing. The world line of the source is linearized along the segment.
+    //
+    struct TileCrossing {
+        vec3  pos;         // The retarded position of the source seen from the center of the tile.
+        float pastTime;    // How long ago the source was there.
+        vec3  vel;         // The change of the position of the source per unit of the past time, i.e. its velocity backwards.
+        float recordRate;  // The records per unit of the past time along the segment of the crossing.
+        int   recordIdx;   // The record starting the segment of the crossing, or -1 if none was found.
+        float recordPos;   // The crossing past `recordIdx`, in records.
+    };
+
+    // The bounding sphere of a tile of targets in the cacheless search of the exact solver, which tests the reach of each source
+    // in place of the flags of `_horizonSkipMat`.
+    //
+    struct TileReach {
+        vec3  center;
+        float skipDist2;  // The squared distance from the center beyond which no source can reach any target of the tile.
+    };
+
+    // How the position history of the bodies is stored.
+    //
+    enum class HistoryEncoding {
+        Full,     // A `vec3` for each record: 12 bytes.
+        Fixed16,  // 16-bit offsets on a grid of each body, which follows the body as it moves: 6 bytes for each record.
+    };
+
+    // A record of the compressed history: the position on the grid of the body, as an offset from the origin of the grid.
+    //
+    struct PackedHistPos {
+        int16_t x;
+        int16_t y;
+        int16_t z;
+    };
+
+    // The grid of the compressed history of a body. The spacing is a power of two, so that the positions of the grid points
+    // up to 2^24 spacings from zero are exact floats. The grid gets shifted by whole points to follow the body, and doubled
+    // once the recorded positions of the body do not fit in 16-bit offsets anymore.
+    //
+    struct HistAnchor {
+        ivec3 originCode;  // The grid point of the zero offset.
+        float scale;       // The spacing of the grid.
+        float errorBound;  // The bound of the error of each coordinate of the recorded positions.
+    };
+
+    // A row of the compressed history, decoded on access, for the search of the light-cone crossings. With the adaptive sampling,
+    // the newest record is read from the staging row, as in the full history.
+    //
+    struct PackedHistRow {
+        std::span<const PackedHistPos> records;
+        int                            firstLevel;  // The finest level of the body, whose slots start the row.
+        int                            firstSlot;
+        const HistAnchor&              anchor;
+        int                            stagedSlot;  // The slot of the newest record in the dense level.
+        const vec3*                    stagedPos;   // Null unless the newest record is staged.
+
+        vec3 operator[](int slot) const { return (stagedPos && slot == stagedSlot) ? *stagedPos : decodeHistPos(records[slot - firstSlot], anchor); }
+    };
+
+    // A row of the full history, with the newest record read from the staging row, which holds it until it is complete.
+    //
+    struct StagedHistRow {
+        std::span<const vec3> records;
+        int                   firstLevel;  // The finest level of the body, whose slots start the row.
+        int                   firstSlot;
+        int                   stagedSlot;  // The slot of the newest record in the dense level.
+        const vec3&           stagedPos;
+
+        vec3 operator[](int slot) const { return (slot == stagedSlot) ? stagedPos : records[slot - firstSlot]; }
+    };
+
+    // A row of the history of either encoding, with the velocities recorded along with the positions for the Hermite
+    // interpolation. The newest velocity is staged like the newest position of the full history.
+    //
+    template<typename PosRow> struct HermiteHistRow {
+        PosRow        positions;
+        StagedHistRow velocities;
+
+        vec3 operator[](int slot) const { return positions[slot]; }
+        vec3 vel(int slot) const { return velocities[slot]; }
+    };
+
+    static vec3 decodeHistPos(const PackedHistPos& pos, const HistAnchor& anchor)
+    {
+        return vec3{(float)(anchor.originCode.x + pos.x) * anchor.scale, (float)(anchor.originCode.y + pos.y) * anchor.scale, (float)(anchor.originCode.z + pos.z) * anchor.scale};
+    }
+
+    // The algorithm used to compute the gravitational accelerations in each step.
+    //
+    enum class ForceSolver {
+        Exact,      // All ordered pairs, each with its own cached light-cone intersection: O(N²) per step.
+        BarnesHut,  // Octree of retarded cell centers of mass, opened by `_openingAngle`: O(N log N) per step.
+        Fmm,        // Fast multipole method over the same octree, with retarded quadrupole moments: O(N) per step.
+        Newtonian,  // All ordered pairs at their current positions, as if the light was infinitely fast: O(N²) per step, with no history.
+        Analytic,   // All ordered pairs, each with the retarded position of the source extrapolated from its current motion: O(N²) per step.
+    };
+
+    // Where the exact solver starts the search of the light-cone crossing of each pair.
+    //
+    enum class ExactSearch {
+        Cached,     // The crossing of the previous step, from the light intersection cache: 4 bytes for each ordered pair.
+        Coherent,   // The crossing of the source shared by the tile of the target, moved by the offset of the target: 32 bytes for each source and tile.
+        Cacheless,  // The record guessed from the light delay of the current distance of the pair: no state for the pairs nor the tiles.
+    };
+
+    // Accuracy of the active force solver, relative to the exact pairwise solution.
+    //
+    struct ForceErrorStats {
+        int   sampleCount = 0;
+        float rmsRelError = 0.0f;
+        float maxRelError = 0.0f;
+    };
+
+    // Cost and accuracy of the search of the light-cone crossings, against an exhaustive scan of the history.
+    //
+    struct RetardedSearchStats {
+        int   sampleCount      = 0;     // Pairs of bodies searched.
+        float meanStepCount    = 0.0f;  // Segments visited per search.
+        int   maxStepCount     = 0;
+        float maxResidual      = 0.0f;  // Of the light-cone criterion at the crossings, relative to the squared distance.
+        float mismatchFraction = 0.0f;  // Of the pairs whose crossing is not the newest one in the history.
     };
 
     int                              _step      = 0;
     int                              _recordIdx = 0;
     float                            _time      = 0.0f;
+    float                            _stepDt    = 0.01f;  // Of the last step, or the longest one before the first.
     vector<float>                    _histTimeArr;
-    vector<Body>                     _bodies;
-    Matrix<vec3>                     _histPosMat;
-    Matrix<LightIntersectCacheEntry> _histInterMat;
+    BodyArray                        _bodies;
+    int                              _sourceCount         = 0;  // The bodies attracting the others, which come first: the rest are tracers.
+    float                            _tracerMassThreshold = 0.0f;
+    bool                             _mergeOnContact      = false;
+    int                              _mergeCount          = 0;  // The bodies merged into others since the respawn.
+    float                            _escapeRadius        = 0.0f;
+    bool                             _keepEscapedMass     = false;
+    int                              _escapeCount         = 0;  // The bodies removed as escapers since the respawn.
+    float                            _escapedMass         = 0.0f;
+    vector<Body>                     _escapedArr;               // The escaped sources kept for their far field, moving on at their last velocities.
+    vector<int>                      _bodyIdArr;               // The stable ID of each body: its index in the spawned bodies.
+    vector<int>                      _bodyIdxArr;              // The index of the body of each ID, as the bodies get reordered.
+    int                              _reorderInterval   = 32;  // Records between the spatial reorderings of the bodies, or zero for none.
+    int                              _reorderRecordIdx  = 0;
+    int                              _reorderCount      = 0;
+    HistoryEncoding                  _historyEncoding   = HistoryEncoding::Full;
+    int                              _histLevelCount    = 1;
+    int                              _recordCount       = 512;  // The record slots of each level, a power of two.
+    bool                             _adaptiveHistory   = true;
+    vector<int>                      _histLevelBeginArr = vector<int>(MaxHistLevelCount, 0);  // The oldest record each level holds, as the earlier ones were not recorded at its depth.
+    RaggedMatrix<vec3>               _histPosMat;       // A row for each source, from the slots of its finest level.
+    vector<vec3>                     _histStagePosArr;  // The newest record of the full history, or of either with the adaptive sampling, time-major: the rows get it once it is complete.
+    int                              _histStageRecordIdx = 0;
+    int                              _recordStepInterval = 16;
+    bool                             _hermiteHistory     = false;
+    RaggedMatrix<vec3>               _histVelMat;       // The velocities of the records, in the slots of the positions, for the Hermite interpolation.
+    vector<vec3>                     _histStageVelArr;  // The velocities of the newest record, staged in either encoding.
+    RaggedMatrix<PackedHistPos>      _histPackedMat;    // With a spare row, as the vectorized kernels load 4 bytes past each record.
+    bool                             _adaptiveSampling  = false;
+    float                            _samplingTolerance = 0.001f;
+    vector<int>                      _histFirstLevelArr;  // The finest level of the history of each source, with the adaptive sampling.
+    vector<HistAnchor>               _histAnchorArr;
+    Matrix<LightIntersectCacheEntry> _histInterMat;  // A row of `ExactTileSize` entries for each tile of targets and each source, as in `interCacheEntry`.
+    vector<int>                      _recordGuessArr;           // The record the search of a cold cache entry starts from, for each bin of the light delay.
+    float                            _recordGuessScale = 0.0f;  // Bins per unit of the squared distance of a pair.
+    bool                             _horizonSkipping  = true;
+    bool                             _sourceBlocking   = true;
+    ExactSearch                      _exactSearch      = ExactSearch::Cached;
+    Matrix<TileCrossing>             _tileCrossingMat;  // For each tile of `ExactTileSize` targets, the crossing of each source shared by the tile.
+    Matrix<uint8_t>                  _horizonSkipMat;   // For each tile of `ExactTileSize` targets, a flag for each source which cannot reach any of them.
+    vector<TileReach>                _tileReachArr;     // For each tile of `ExactTileSize` targets in the cacheless search, instead of `_horizonSkipMat`.
+    int64_t                          _horizonSkipCount = 0;
+    float                            _horizonReach2    = std::numeric_limits<float>::infinity();  // The squared distance from a target beyond which no source can reach it.
+
+    ForceSolver          _forceSolver            = ForceSolver::Exact;
+    SimdIsa              _simdIsa                = detectSimdIsa();
+    float                _openingAngle           = 0.5f;
+    bool                 _analyticFallback       = true;
+    float                _analyticErrorTolerance = 0.01f;
+    float                _analyticMaxSpeedRatio  = 0.3f;
+    vector<float>        _sourceJerkArr;  // The change of the acceleration of each body over the last step, per unit of time.
+    uptr<RetardedOctree> _octree;
+    uptr<RetardedFmm>    _fmm;
+    uptr<ThreadPool>     _threadPool;
+
+    int             _forceErrorSampleCount = 0;
+    ForceErrorStats _forceErrorStats;
+
+    mutable std::atomic<int> _outOfWindowCounter    = 0;  // Counted by the threads of the force pass.
+    int                      _outOfWindowCount      = 0;
+    int64_t                  _outOfWindowTotal      = 0;
+    std::atomic<int64_t>     _analyticFallbackCount = 0;  // Counted by the threads of the force pass.
 
 public:
-    NBodySim() = default;
-    ~NBodySim() = default;
+    NBodySim();
+    ~NBodySim();
 
-    void  respawn(vector<Body>&& bodies);
+    void  respawn(std::span<const Body> bodies, std::optional<ForceSolver> forceSolver = std::nullopt);
     float simTime() const { return _time; }
     void  step(float dt);
 
+    // Views of the body storage, e.g. for uploading to the renderer without a copy.
+    int                    bodyCount() const { return _bodies.size(); }
+    std::span<const vec3>  bodyPositions() const { return _bodies.field<&Body::pos>(); }
+    std::span<const float> bodyMasses() const { return _bodies.field<&Body::mass>(); }
+    std::span<const vec3>  bodyAccelerations() const { return _bodies.field<&Body::accel>(); }
+
+    // The bodies get reordered along a Morton curve through their bounding cube at the respawn and every `reorderInterval`
+    // records, so that the bodies close in space are close in memory: the tiles of the exact solver, the chunks of the tree
+    // solvers and the uploads of the renderer then cover compact groups of bodies. The history, the light intersection cache and
+    // the octree follow the bodies. The views above are in the current order; `bodyIds` maps it to the stable IDs, which are the
+    // indices in the spawned bodies, and `reorderCount` changes with the order and with the set of bodies. Zero disables the
+    // periodic reordering.
+    int                  reorderInterval() const { return _reorderInterval; }
+    void                 setReorderInterval(int reorderInterval) { _reorderInterval = std::max(reorderInterval, 0); }
+    int                  reorderCount() const { return _reorderCount; }
+    std::span<const int> bodyIds() const { return _bodyIdArr; }
+    int                  bodyIndex(int bodyId) const { return _bodyIdxArr[bodyId]; }
+
+    // The bodies whose mass does not exceed `tracerMassThreshold` are tracers: they feel the attraction of the other bodies, the
+    // sources, but exert none. They keep no history, no entries of the light intersection cache and no crossings of the tiles, and
+    // a step of the pairwise solvers costs O(sources · bodies) rather than O(bodies²); the tree solvers leave them out of the tree.
+    // The sources come first in the order of the bodies, as the first `sourceCount` ones. By default, only the massless bodies are
+    // tracers. Changing the threshold moves the bodies to the new split and starts the history of the sources anew, extrapolated
+    // from their current motion, as in `setForceSolver`.
+    float tracerMassThreshold() const { return _tracerMassThreshold; }
+    void  setTracerMassThreshold(float tracerMassThreshold);
+    int   sourceCount() const { return _sourceCount; }
+
+    // With the merging on contact, the bodies whose spheres overlap at the end of a step merge inelastically into the heaviest of
+    // them. The merged body carries their total energy and momentum, so its rest mass also takes up the kinetic energy of their
+    // relative motion. The tracers only merge into sources, as they do not interact among themselves. The other bodies are
+    // dropped along with all their state, so a long run gets cheaper as its bodies merge; `bodyIndex` gives -1 for their IDs.
+    // The spheres have the density `BodyDensity`, as in `bodyRadius`.
+    bool         mergeOnContact() const { return _mergeOnContact; }
+    void         setMergeOnContact(bool mergeOnContact) { _mergeOnContact = mergeOnContact; }
+    int          mergeCount() const { return _mergeCount; }
+    static float bodyRadius(float mass) { return std::cbrt(3.0f / (4.0f * glm::pi<float>()) * mass / BodyDensity); }
+
+    // With an escape radius, the bodies farther than it from the center of mass which recede from it unbound get removed along
+    // with all their state, as for the merging: they would stay in the force pass of every step, and stretch the history to the
+    // delay of the signals across the growing system. A body is unbound if its kinetic energy relative to the center of mass exceeds
+    // the potential of the other bodies, taken as a point mass there, which holds far out at speeds well below c. The check runs
+    // with that of the depth of the history, every `HistDepthCheckInterval` records. With `keepEscapedMass`, the escaped sources
+    // keep pulling the system as a whole: their attraction at the center of mass, from their retarded positions along straight
+    // world lines, adds to every body as a single uniform acceleration, the leading term of the far field of masses around the
+    // system. `escapedMass` is the total mass of the escaped sources, which the far field keeps. Zero disables the removal.
+    float escapeRadius() const { return _escapeRadius; }
+    void  setEscapeRadius(float escapeRadius) { _escapeRadius = std::max(escapeRadius, 0.0f); }
+    bool  keepEscapedMass() const { return _keepEscapedMass; }
+    void  setKeepEscapedMass(bool keepEscapedMass);
+    int   escapeCount() const { return _escapeCount; }
+    float escapedMass() const { return _escapedMass; }
+
+    // The compressed history takes half the memory and the bandwidth of the full one, at the cost of the error of the recorded
+    // positions, bounded by `historyErrorBound` in each coordinate. Switching the encoding converts the history in place.
+    HistoryEncoding historyEncoding() const { return _historyEncoding; }
+    void            setHistoryEncoding(HistoryEncoding historyEncoding);
+    float           historyErrorBound() const;
+    size_t          historyByteCount() const;
+
+    // The history is kept in levels of `historyRecordCount` record slots each: level `l` holds every 2^l-th record, so each level
+    // looks twice as far back as the previous one. The search of the light-cone crossings walks the dense recent records first,
+    // then the sparser older ones, which lets the light cross systems far wider than the dense level, at a memory cost growing
+    // with the logarithm of the depth. Switching the level count restarts the history from the current positions of the bodies,
+    // as the coarse levels cannot be filled from a shorter one.
+    int   historyLevelCount() const { return _histLevelCount; }
+    void  setHistoryLevelCount(int levelCount);
+    float historyLookBack() const { return _histTimeArr.empty() ? 0.0f : _time - _histTimeArr[histRecordSlot(oldestRecordIdx())]; }
+
+    // The history records the positions of the bodies every `recordStepInterval` steps, and the search of the light-cone crossings
+    // interpolates their world lines between the records: linearly, or with the cubic Hermite interpolation of the positions and
+    // of the velocities recorded along with them. The latter follows the curved world lines of orbits closely enough for records
+    // several times sparser at the same accuracy, so for a history as many times shorter in records. The velocities take
+    // 12 bytes for each record, in either encoding. Enabling the interpolation estimates the velocities of the records already
+    // in the history from their neighbours. The histories of the cells of the tree solvers are interpolated linearly.
+    int  recordStepInterval() const { return _recordStepInterval; }
+    void setRecordStepInterval(int recordStepInterval) { _recordStepInterval = std::max(recordStepInterval, 1); }
+    bool hermiteHistory() const { return _hermiteHistory; }
+    void setHermiteHistory(bool hermiteHistory);
+
+    // With the adaptive sampling, each body keeps the levels of the history from a finest level of its own, so the bodies whose
+    // world lines hardly curve between the records skip the dense levels, and their searches interpolate across them along the
+    // coarser records. At each check of the depth, the finest level of a body follows the error of the linear interpolation of
+    // its world line between records 2^level apart, |a| Δt² / 8 for its acceleration a, against `samplingTolerance`, a distance.
+    // The records keep the timeline shared by the bodies, so the sampling rates are the powers of two of their pace, and the
+    // bodies of a single-level history keep every record. The levels a body gains are interpolated from the records it keeps.
+    bool  adaptiveSampling() const { return _adaptiveSampling; }
+    void  setAdaptiveSampling(bool adaptiveSampling);
+    float samplingTolerance() const { return _samplingTolerance; }
+    void  setSamplingTolerance(float samplingTolerance) { _samplingTolerance = samplingTolerance; }
+    int   histFirstLevel(int body_idx) const { return _histFirstLevelArr.empty() ? 0 : _histFirstLevelArr[body_idx]; }
+
+    // The depth of each level of the history, in records. With the adaptive depth, it follows the delay of the signals across
+    // the system, as measured by its bounding radius and the observed pace of the records: it grows as soon as the history
+    // gets too short, and shrinks once it is four times too long. Resizing keeps the records which fit in the new depth.
+    int  historyRecordCount() const { return _recordCount; }
+    void setHistoryRecordCount(int recordCount);
+    bool adaptiveHistory() const { return _adaptiveHistory; }
+    void setAdaptiveHistory(bool adaptiveHistory) { _adaptiveHistory = adaptiveHistory; }
+
+    // The exact solver skips the pairs which provably have no recorded position of the source inside the past light cone of
+    // the target, e.g. early in a run or between distant galaxies. The bound follows from the current distance of the source
+    // to the target, or to a whole tile of targets, the look-back of the history and `MaxSpeedCap`. `horizonSkipCount` is the
+    // number of the pairs skipped with their tiles in the last step.
+    bool    horizonSkipping() const { return _horizonSkipping; }
+    void    setHorizonSkipping(bool horizonSkipping) { _horizonSkipping = horizonSkipping; }
+    int64_t horizonSkipCount() const { return _horizonSkipCount; }
+
+    // The exact solver sweeps the sources in blocks whose history rows fit in the L2 cache, each with all the tiles of targets of
+    // a chunk in turn; without the blocking, each tile sweeps all the sources at once. The results are the same.
+    bool sourceBlocking() const { return _sourceBlocking; }
+    void setSourceBlocking(bool sourceBlocking) { _sourceBlocking = sourceBlocking; }
+
+    // In the coherent search, the exact solver searches the crossing of each source once for the center of each tile of targets,
+    // warm from the crossing of the previous step. Each target then starts its own search from that crossing, moved along the
+    // world line of the source by its offset from the center, rather than from the light intersection cache, which is released.
+    // This suits spatially compact tiles, whose targets see the sources at nearly the same time.
+    // In the cacheless search, each pair starts from the record as old as the light delay of its current distance, and brackets
+    // the crossing from there, which takes a few more segments per search than the cache. The solver then keeps no state growing
+    // with the square of the number of bodies: neither the cache, nor the crossings or the horizon flags of the tiles.
+    // `searchStateByteCount` is the memory the solver keeps for the searches, besides the history.
+    ExactSearch exactSearch() const { return _exactSearch; }
+    void        setExactSearch(ExactSearch exactSearch);
+    size_t      searchStateByteCount() const;
+
+    // The number of pairs whose retarded point was older than the oldest record in the last step, after the history has started
+    // to drop records, and the total since the respawn. These pairs exert no force: the history is too short for the system.
+    int     outOfWindowCount() const { return _outOfWindowCount; }
+    int64_t outOfWindowTotal() const { return _outOfWindowTotal; }
+
+    // The recorded position of a body in a slot of the history, decoded. The slots of level 0 are the record indices modulo `historyRecordCount`.
+    // The slots of the levels finer than those of the body are interpolated linearly between its records.
+    vec3 histPos(int slot, int body_idx) const;
+    int  oldestRecordIdx() const { return levelOldestRecordIdx(_histLevelCount - 1); }
+    int  newestRecordIdx() const { return _recordIdx; }
+
+    // The oldest record of a level, a multiple of 2^level. The newest one is the newest multiple of 2^level. The levels finer than
+    // `first_level`, the finest one of a body, hold only the newest record for it.
+    int levelOldestRecordIdx(int level, int first_level = 0) const
+    {
+        return (level < first_level) ? _recordIdx : std::max(_histLevelBeginArr[level], (_recordIdx & -(1 << level)) - (_recordCount - 1) * (1 << level));
+    }
+
+    // The Newtonian solver sums the attractions of all the bodies at their current positions, with the vectorized kernels, as
+    // the baseline of the retarded solvers and the limit of an infinite speed of light. It keeps no history and no light
+    // intersection cache, which get released. When a solver with a history takes over, e.g. after a Newtonian warm-up, the history
+    // gets extrapolated back along straight world lines at the current velocities of the bodies, so that the retarded forces
+    // start from a full causal past rather than from the causal front of a respawn.
+    ForceSolver forceSolver() const { return _forceSolver; }
+    void        setForceSolver(ForceSolver forceSolver);
+    float       openingAngle() const { return _openingAngle; }
+    void        setOpeningAngle(float openingAngle) { _openingAngle = openingAngle; }
+
+    // The analytic solver extrapolates the world line of each source back from its current position, velocity and acceleration,
+    // and solves for its crossing of the past light cone of each target, with no search and no cache. This suits weakly
+    // relativistic systems. A pair falls back to the search of the history, from the extrapolated crossing, if the source is faster
+    // than `analyticMaxSpeedRatio` · c, or if the error of the force estimated from the jerk of the source exceeds
+    // `analyticErrorTolerance`, relative to the force. Without the fallback, the solver keeps no history, and its memory is linear
+    // in the number of bodies. `analyticFallbackCount` is the number of the pairs which fell back in the last step.
+    bool    analyticFallback() const { return _analyticFallback; }
+    void    setAnalyticFallback(bool analyticFallback);
+    float   analyticErrorTolerance() const { return _analyticErrorTolerance; }
+    void    setAnalyticErrorTolerance(float analyticErrorTolerance) { _analyticErrorTolerance = analyticErrorTolerance; }
+    float   analyticMaxSpeedRatio() const { return _analyticMaxSpeedRatio; }
+    void    setAnalyticMaxSpeedRatio(float analyticMaxSpeedRatio) { _analyticMaxSpeedRatio = analyticMaxSpeedRatio; }
+    int64_t analyticFallbackCount() const { return _analyticFallbackCount; }
+
+    // The instruction set of the vectorized kernels of the exact and the Newtonian solvers: the best supported one by default.
+    // Requests for instruction sets not supported by the CPU fall back to the best supported one; `SimdIsa::Scalar` is the reference.
+    SimdIsa simdIsa() const { return _simdIsa; }
+    void    setSimdIsa(SimdIsa simdIsa) { _simdIsa = std::min(simdIsa, detectSimdIsa()); }
+
+    // The number of threads sharing the phases of a step, including the calling one. Zero stands for all the hardware threads.
+    // The work is split by bodies, so the results do not depend on the number of threads.
+    int  threadCount() const { return _threadPool->threadCount(); }
+    void setThreadCount(int threadCount);
+
+    // The pool running the phases of the steps, which may run other work between them, e.g. for the frames.
+    ThreadPool& threadPool() { return *_threadPool; }
+
+    // Acceleration exerted on a target by a point mass seen at `source_pos`, including the softening of close encounters.
+    static vec3 gravAccel(const vec3& target_pos, const vec3& source_pos, float source_mass)
+    {
+        const float distSq = glm::distance2(source_pos, target_pos);
+        return (source_pos - target_pos) / (distSq * std::sqrt(distSq) + GravSoftening) * source_mass;
+    }
+
+    // Comparison mode: if enabled, each step compares the accelerations of up to `sampleCount` bodies, as computed by the active solver,
+    // against the exact pairwise solution. The exact solution is computed without touching the light intersection cache; for the
+    // Newtonian solver, it is the scalar sum over the current positions. The analytic solver without its fallback has none.
+    void            setForceErrorSampleCount(int sampleCount) { _forceErrorSampleCount = sampleCount; }
+    ForceErrorStats forceErrorStats() const { return _forceErrorStats; }
+
+    // Searches the crossings between up to `sampleCount` targets and all the sources, from the hints of the light intersection
+    // cache if the exact solver is active, from the guesses of the coherent or the cacheless search if either is on, or from those
+    // of `guessRecordIdx` otherwise. Neither the cache nor the bodies change.
+    RetardedSearchStats measureRetardedSearch(int sampleCount) const;
+
 private:
-    void applyGravAccel(int body1_ix, int body2_ix);
+    void                     resetSolverState();
+    void                     integrate(float dt);
+    void                     recordHistory();
+    void                     resetHistory();
+    void                     extrapolateHistory();
+    void                     adaptHistoryDepth();
+    void                     adaptHistorySampling();
+    void                     resampleHistory(vector<int> firstLevelArr);
+    vector<int>              histRowStarts(bool spareRow) const;
+    vec3                     histVel(int slot, int body_idx) const;
+    void                     recordPackedPos(int record_idx, int body_idx, const vec3& pos);
+    void                     commitStagedRecord();
+    void                     estimateHistVelocities();
+    vector<int>              spatialOrder() const;
+    void                     permuteBodies(std::span<const int> order);
+    void                     reorderBodies();
+    void                     mergeTouchingBodies();
+    void                     removeEscapers();
+    void                     applyEscapedPull();
+    Body                     massCenter() const;
+    void                     compactBodies(std::span<const int> keptBodies);
+    void                     applyExactGravAccels();
+    void                     applyNewtonianGravAccels();
+    void                     applyAnalyticGravAccels();
+    void                     updateSourceJerks();
+    bool                     findAnalyticRetardedPos(const vec3& target_pos, int source_body_idx, float maxSpeedSq, float jerkBound, float& past_time, vec3& sb_pos) const;
+    bool                     searchGravAccel(const vec3& target_pos, int source_body_idx, float past_time, vec3& accel) const;
+    void                     applyGravAccel(int body1_ix, int body2_ix, const TileCrossing* tile_crossing = nullptr);
+    void                     decodeCacheEntry(const LightIntersectCacheEntry& entry, int& hist_record_idx, float& hist_alpha) const;
+    LightIntersectCacheEntry encodeCacheEntry(int hist_record_idx, float hist_alpha) const;
+    int                      exactBlockSize() const;
+    vec3                     computeExactGravAccel(int target_body_idx) const;
+    vec3                     computePairGravAccel(const vec3& target_pos, int source_body_idx) const;
+    vec3                     computeNewtonianGravAccel(int target_body_idx) const;
+    ForceErrorStats          measureForceError(int sampleCount) const;
+
+    // Locates the point where the world line recorded in `s_pos_arr` crosses the past light cone of `target_pos`.
+    // The search starts from the record of the intersection hint (`hist_record_idx`, `hist_alpha`), and updates the hint.
+    // Returns false if the crossing is not within the recorded history.
+    // The search walks the first `level_count` levels of the row, all the `_histLevelCount` ones for the bodies and the octree cells.
+    // `search_step_count`, if given, is incremented for each segment visited. A crossing older than the history counts in the pairs
+    // out of the window unless `count_out_of_window` is false, as for the searches which are not those of a pair.
+    bool findRetardedPos(const vec3& target_pos, std::span<const vec3> s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count = 1) const;
+    bool findRetardedPos(const vec3& target_pos, const PackedHistRow& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count = 1) const;
+    bool findRetardedPos(const vec3& target_pos, const StagedHistRow& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count = 1) const;
+    bool findRetardedPos(const vec3& target_pos, const HermiteHistRow<PackedHistRow>& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count = 1) const;
+    bool findRetardedPos(const vec3& target_pos, const HermiteHistRow<StagedHistRow>& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count = 1) const;
+    template<typename HistRow> bool findRetardedPosIn(const vec3& target_pos, const HistRow& s_pos_arr, int& hist_record_idx, float& hist_alpha, vec3& sb_pos, int level_count,
+                                                      int* search_step_count = nullptr, bool count_out_of_window = true) const;
+
+    // The cache entry of a pair. The entries of a tile of targets are contiguous for each source, and the sources follow each
+    // other within the tile, so that a tile sweeping the sources streams through its part of the cache.
+    LightIntersectCacheEntry& interCacheEntry(int target_body_idx, int source_body_idx)
+    {
+        return _histInterMat({target_body_idx % ExactTileSize, (target_body_idx / ExactTileSize) * _sourceCount + source_body_idx});
+    }
+    const LightIntersectCacheEntry& interCacheEntry(int target_body_idx, int source_body_idx) const
+    {
+        return _histInterMat({target_body_idx % ExactTileSize, (target_body_idx / ExactTileSize) * _sourceCount + source_body_idx});
+    }
+
+    // Calls `fn` with the history row of a body: a row of positions with the staged newest one, or a compressed row, depending
+    // on the active encoding, along with the velocities of the Hermite interpolation if it is enabled.
+    template<typename Fn> auto withHistRow(int body_idx, Fn&& fn) const
+    {
+        const int   first_level = histFirstLevel(body_idx);
+        const int   first_slot  = first_level * _recordCount;
+        const int   staged_slot = histLevelSlot(0, _histStageRecordIdx);
+        const vec3* staged_pos  = _histStagePosArr.empty() ? nullptr : &_histStagePosArr[body_idx];
+        if (_hermiteHistory) {
+            const StagedHistRow vel_row{_histVelMat.row(body_idx), first_level, first_slot, staged_slot, _histStageVelArr[body_idx]};
+            if (_historyEncoding == HistoryEncoding::Fixed16) {
+                return fn(HermiteHistRow<PackedHistRow>{PackedHistRow{_histPackedMat.row(body_idx), first_level, first_slot, _histAnchorArr[body_idx], staged_slot, staged_pos}, vel_row});
+            }
+            return fn(HermiteHistRow<StagedHistRow>{StagedHistRow{_histPosMat.row(body_idx), first_level, first_slot, staged_slot, *staged_pos}, vel_row});
+        }
+        if (_historyEncoding == HistoryEncoding::Fixed16) {
+            return fn(PackedHistRow{_histPackedMat.row(body_idx), first_level, first_slot, _histAnchorArr[body_idx], staged_slot, staged_pos});
+        }
+        return fn(StagedHistRow{_histPosMat.row(body_idx), first_level, first_slot, staged_slot, *staged_pos});
+    }
+
+    // The finest level held by a history row: that of its body, or the dense one of the rows of the octree cells, which hold every level.
+    template<typename HistRow> static int histRowFirstLevel(const HistRow& row)
+    {
+        if constexpr (requires { row.positions.firstLevel; }) {
+            return row.positions.firstLevel;
+        } else if constexpr (requires { row.firstLevel; }) {
+            return row.firstLevel;
+        } else {
+            return 0;
+        }
+    }
+
+    // The slot of a record in a level, and the finest of the first `level_count` levels reaching back to the record, from
+    // `first_level` on but for the newest record.
+    int histLevelSlot(int level, int record_idx) const { return level * _recordCount + (record_idx >> level) % _recordCount; }
+    int histRecordLevel(int record_idx, int level_count, int first_level = 0) const;
+    int histRecordSlot(int record_idx, int first_level = 0) const { return histLevelSlot(histRecordLevel(record_idx, _histLevelCount, first_level), record_idx); }
+
+    // The record following a record of a level along the chain of the levels searched by `findRetardedPos`.
+    int histSegmentEnd(int record_idx, int level, int first_level = 0) const
+    {
+        return (level == 0) ? record_idx + 1 : std::min(record_idx + (1 << level), levelOldestRecordIdx(level - 1, first_level));
+    }
+
+    // Interpolates a slot of a level finer than those of a body between the records it holds, read by `heldValue(slot)`.
+    template<typename Fn> vec3 interpolateHistSlot(int slot, int body_idx, Fn&& heldValue) const;
+
+    // Calls `fn(slot)` for each slot holding the record `record_idx`, one in each level it belongs to, from `first_level` on.
+    template<typename Fn> void forEachRecordSlot(int record_idx, Fn&& fn, int first_level = 0) const
+    {
+        for (int level = 0; level < _histLevelCount && record_idx % (1 << level) == 0; ++level) {
+            if (level >= first_level && record_idx >= levelOldestRecordIdx(level) && record_idx <= _recordIdx) {
+                fn(histLevelSlot(level, record_idx));
+            }
+        }
+    }
+
+    // Calls `fn(slot, record_idx)` for each slot of the history holding a record, level by level from `first_level` on.
+    template<typename Fn> void forEachHistSlot(Fn&& fn, int first_level = 0) const
+    {
+        for (int level = first_level; level < _histLevelCount; ++level) {
+            for (int ir = levelOldestRecordIdx(level); ir <= _recordIdx; ir += 1 << level) {
+                fn(histLevelSlot(level, ir), ir);
+            }
+        }
+    }
+
+    // Returns the index of the most recent history record which is at least `pastTime` old, as a starting hint for `findRetardedPos`.
+    int guessRecordIdx(float pastTime, int level_count = 1) const;
+
+    // The cache entries older than the history are cold: left by a reset of the cache, or by a pair which has fallen out of the
+    // history. Their search starts from the record guessed from the light delay of the current distance of the pair, looked up
+    // in a table of `guessRecordIdx` over the look-back of the history, which the vectorized kernels share.
+    void updateRecordGuesses();
+
+    // Flags the sources out of the reach of each tile of targets of the exact solver, as in `horizonSkipping`, or bounds the reach of
+    // each tile in the cacheless search.
+    void updateHorizonSkips();
+    bool outOfTileReach(int tile, const vec3& source_pos) const { return glm::distance2(_tileReachArr[tile].center, source_pos) > _tileReachArr[tile].skipDist2; }
+    void tileBounds(int tile, vec3& center, float& radius) const;
+
+    // Searches the crossings shared by the tiles of targets in the coherent search, and guesses the record a target of a tile
+    // starts its own search from: one step of Newton's method on the light-cone criterion from the shared crossing.
+    void updateTileCrossings();
+    int  guessTileRecordIdx(const TileCrossing& tile_crossing, const vec3& target_pos) const;
+    int  guessCachedRecordIdx(float dist2) const { return _recordGuessArr[(int)std::min(dist2 * _recordGuessScale, (float)(RecordGuessBinCount - 1))]; }
+
+    // Whether a body of the given mass is a tracer, as in `tracerMassThreshold`.
+    bool isTracerMass(float mass) const { return mass <= _tracerMassThreshold; }
+
+    // The Newtonian solver keeps no history, nor does the analytic one without its fallback.
+    bool keepsHistory() const { return _forceSolver != ForceSolver::Newtonian && (_forceSolver != ForceSolver::Analytic || _analyticFallback); }
+
+    // Returns how long ago a signal must have left a source at squared distance `dist2` to reach the target now.
+    // Follows the light-cone criterion of `findRetardedPos` (c² · t ≥ d²).
+    float lightDelay(float dist2) const { return dist2 * LightSpeedInvSq; }
 };
 
 // ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,192 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "nbody/retarded_fmm.hpp"
+
+#include "nbody/nbody_sim.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+void RetardedFmm::applyGravAccels(NBodySim& sim, const RetardedOctree& octree)
+{
+    const auto& cells     = octree._cells;
+    const int   cellCount = (int)cells.size();
+    if (cellCount == 0) {
+        return;
+    }
+
+    _locals.assign(cellCount, LocalExpansion{});
+    interact(sim, octree, 0, 0);
+
+    // Pass the local expansions down the top of the tree, one level at a time, until it splits into enough subtrees.
+    _subtreeRoots.assign(1, 0);
+    bool split = true;
+    while (split && (int)_subtreeRoots.size() < MinSubtreeCount) {
+        split = false;
+        _splitRoots.clear();
+        for (const int ic : _subtreeRoots) {
+            if (cells[ic].isLeaf) {
+                _splitRoots.push_back(ic);
+                continue;
+            }
+            passDown(sim, octree, ic, ic + 1);
+            for (int ich = ic + 1; ich < cells[ic].skip; ich = cells[ich].skip) {
+                _splitRoots.push_back(ich);
+            }
+            split = true;
+        }
+        std::swap(_subtreeRoots, _splitRoots);
+    }
+
+    // The subtrees share neither cells nor bodies.
+    sim._threadPool->parallelFor((int)_subtreeRoots.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const int ic = _subtreeRoots[i];
+            passDown(sim, octree, ic, cells[ic].skip);
+        }
+    });
+
+    // The tracers are not in the tree, so they walk it as the Barnes-Hut targets do.
+    const auto body_accel_arr = sim._bodies.field<&NBodySim::Body::accel>();
+    sim._threadPool->parallelFor(sim.bodyCount() - sim.sourceCount(), sim.BarnesHutChunkSize, [&](int begin, int end) {
+        for (int ib = sim.sourceCount() + begin; ib < sim.sourceCount() + end; ++ib) {
+            body_accel_arr[ib] += octree.computeGravAccel(sim, ib);
+        }
+    });
+}
+
+// Passes the local expansions of the cells in [`cell_begin`, `cell_end`) down to their children, or to the member bodies of the
+// leaves. The parents precede their children in the depth-first order.
+//
+void RetardedFmm::passDown(NBodySim& sim, const RetardedOctree& octree, int cell_begin, int cell_end)
+{
+    const auto& cells          = octree._cells;
+    const auto  body_accel_arr = sim._bodies.field<&NBodySim::Body::accel>();
+    for (int ic = cell_begin; ic < cell_end; ++ic) {
+        const auto& cell  = cells[ic];
+        const auto& local = _locals[ic];
+
+        if (cell.isLeaf) {
+            for (int i = cell.bodyBegin; i < cell.bodyEnd; ++i) {
+                const int ib = octree._bodyOrder[i];
+                body_accel_arr[ib] += local.accelAt(sim.bodyPositions()[ib] - cell.com);
+            }
+        } else {
+            for (int ich = ic + 1; ich < cell.skip; ich = cells[ich].skip) {
+                const vec3 d = cells[ich].com - cell.com;
+                _locals[ich].accel += local.accelAt(d);
+                _locals[ich].accelGrad += local.accelGrad;
+                _locals[ich].accelGrad += local.accelGrad2 * d;
+                _locals[ich].accelGrad2 += local.accelGrad2;
+            }
+        }
+    }
+}
+
+void RetardedFmm::interact(NBodySim& sim, const RetardedOctree& octree, int target_cell_idx, int source_cell_idx)
+{
+    const auto& cells       = octree._cells;
+    const auto& target_cell = cells[target_cell_idx];
+    const auto& source_cell = cells[source_cell_idx];
+
+    if (target_cell_idx != source_cell_idx) {
+        const float dist = glm::distance(target_cell.com, source_cell.com);
+        if (target_cell.radius + source_cell.radius < sim._openingAngle * dist) {
+            interactMultipole(sim, octree, target_cell_idx, source_cell_idx);
+            return;
+        }
+    }
+
+    if (target_cell.isLeaf && source_cell.isLeaf) {
+        interactBodies(sim, octree, target_cell_idx, source_cell_idx);
+        return;
+    }
+
+    // Split the larger of the cells, unless it cannot be split.
+    const bool splitTarget = source_cell.isLeaf || (!target_cell.isLeaf && target_cell.radius >= source_cell.radius);
+    if (splitTarget) {
+        for (int ich = target_cell_idx + 1; ich < target_cell.skip; ich = cells[ich].skip) {
+            interact(sim, octree, ich, source_cell_idx);
+        }
+    } else {
+        for (int ich = source_cell_idx + 1; ich < source_cell.skip; ich = cells[ich].skip) {
+            interact(sim, octree, target_cell_idx, ich);
+        }
+    }
+}
+
+// Adds the field of the source cell, at its retarded time, to the local expansion of the target cell.
+//
+void RetardedFmm::interactMultipole(const NBodySim& sim, const RetardedOctree& octree, int target_cell_idx, int source_cell_idx)
+{
+    const auto& target_cell = octree._cells[target_cell_idx];
+    const auto& source_cell = octree._cells[source_cell_idx];
+    const vec3  center      = target_cell.com;
+
+    int   hist_record_idx = sim.guessRecordIdx(sim.lightDelay(glm::distance2(center, source_cell.com)), sim._histLevelCount);
+    float hist_alpha      = 0.0f;
+    vec3  sb_pos{};
+    if (!sim.findRetardedPos(center, octree._histComMat.row(source_cell_idx), hist_record_idx, hist_alpha, sb_pos, sim._histLevelCount)) {
+        return;
+    }
+
+    // The quadrupole moment is interpolated within the same history segment as the center of mass, which may span a coarser level.
+    const int     s0_level = sim.histRecordLevel(hist_record_idx, sim._histLevelCount);
+    const int     s1_idx   = sim.histSegmentEnd(hist_record_idx, s0_level);
+    const auto    quad_arr = octree._histQuadMat.row(source_cell_idx);
+    const SymMat3 quad     = SymMat3::lerp(quad_arr[sim.histRecordSlot(hist_record_idx)], quad_arr[sim.histRecordSlot(s1_idx)], hist_alpha);
+
+    // With r = center - sb_pos, the acceleration is the gradient of M/|r| + (1/2) rᵀQr/|r|⁵:
+    //      a = -M r/|r|³ + Q r/|r|⁵ - (5/2) (rᵀQr) r/|r|⁷
+    // and its derivatives are taken from the monopole term only:
+    //      ∂ⱼaᵢ   = M (3 rᵢrⱼ/|r|⁵ - δᵢⱼ/|r|³)
+    //      ∂ₖ∂ⱼaᵢ = M (-15 rᵢrⱼrₖ/|r|⁷ + 3 (rᵢδⱼₖ + rⱼδᵢₖ + rₖδᵢⱼ)/|r|⁵)
+    // The monopole terms of the first two are softened in the same way as the attraction between bodies, |r|³ becoming |r|³ + ε.
+    const vec3  r        = center - sb_pos;
+    const float r2       = glm::length2(r);
+    const float rLen     = std::sqrt(r2);
+    const float invR2    = 1.0f / r2;
+    const float invR5    = invR2 * invR2 / rLen;
+    const float invR7    = invR5 * invR2;
+    const float invSoft3 = 1.0f / (r2 * rLen + NBodySim::GravSoftening);
+    const float mass     = source_cell.mass;
+    const vec3  quad_r   = quad * r;
+
+    auto& local = _locals[target_cell_idx];
+    local.accel += -mass * invSoft3 * r + invR5 * quad_r - 2.5f * glm::dot(r, quad_r) * invR7 * r;
+    local.accelGrad += SymMat3::outer(r, 3.0f * mass * rLen * invSoft3 * invSoft3, -mass * invSoft3);
+    local.accelGrad2 += SymTensor3::outer(r, -15.0f * mass * invR7, 3.0f * mass * invR5);
+}
+
+void RetardedFmm::interactBodies(NBodySim& sim, const RetardedOctree& octree, int target_cell_idx, int source_cell_idx)
+{
+    const auto& target_cell = octree._cells[target_cell_idx];
+    const auto& source_cell = octree._cells[source_cell_idx];
+
+    for (int it = target_cell.bodyBegin; it < target_cell.bodyEnd; ++it) {
+        const int   ib         = octree._bodyOrder[it];
+        const vec3& target_pos = sim.bodyPositions()[ib];
+        vec3&       accel      = sim._bodies.field<&NBodySim::Body::accel>()[ib];
+
+        for (int is = source_cell.bodyBegin; is < source_cell.bodyEnd; ++is) {
+            const int source_body_idx = octree._bodyOrder[is];
+            if (source_body_idx != ib) {
+                accel += sim.computePairGravAccel(target_pos, source_body_idx);
+            }
+        }
+    }
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,113 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#pragma once
+
+#include "core/basic_types.hpp"
+#include "nbody/retarded_octree.hpp"
+
+class NBodySim;
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A fully symmetric 3x3x3 tensor, such as the gradient of a tidal tensor.
+//
+struct SymTensor3 {
+    float xxx, xxy, xxz, xyy, xyz, xzz, yyy, yyz, yzz, zzz;
+
+    // Contracts the last index with `v`.
+    SymMat3 operator*(const vec3& v) const
+    {
+        return SymMat3{
+            .xx = xxx * v.x + xxy * v.y + xxz * v.z,
+            .yy = xyy * v.x + yyy * v.y + yyz * v.z,
+            .zz = xzz * v.x + yzz * v.y + zzz * v.z,
+            .xy = xxy * v.x + xyy * v.y + xyz * v.z,
+            .xz = xxz * v.x + xyz * v.y + xzz * v.z,
+            .yz = xyz * v.x + yyz * v.y + yzz * v.z,
+        };
+    }
+
+    SymTensor3& operator+=(const SymTensor3& t)
+    {
+        xxx += t.xxx, xxy += t.xxy, xxz += t.xxz, xyy += t.xyy, xyz += t.xyz;
+        xzz += t.xzz, yyy += t.yyy, yyz += t.yyz, yzz += t.yzz, zzz += t.zzz;
+        return *this;
+    }
+
+    // Returns `scale` * v⊗v⊗v + `trace` * (v⊗I + its index permutations), i.e. the components scale vᵢvⱼvₖ + trace (vᵢδⱼₖ + vⱼδᵢₖ + vₖδᵢⱼ).
+    static SymTensor3 outer(const vec3& v, float scale, float trace)
+    {
+        return SymTensor3{
+            .xxx = scale * v.x * v.x * v.x + 3.0f * trace * v.x,
+            .xxy = scale * v.x * v.x * v.y + trace * v.y,
+            .xxz = scale * v.x * v.x * v.z + trace * v.z,
+            .xyy = scale * v.x * v.y * v.y + trace * v.x,
+            .xyz = scale * v.x * v.y * v.z,
+            .xzz = scale * v.x * v.z * v.z + trace * v.x,
+            .yyy = scale * v.y * v.y * v.y + 3.0f * trace * v.y,
+            .yyz = scale * v.y * v.y * v.z + trace * v.z,
+            .yzz = scale * v.y * v.z * v.z + trace * v.y,
+            .zzz = scale * v.z * v.z * v.z + 3.0f * trace * v.z,
+        };
+    }
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A fast multipole method working on a `RetardedOctree` which records the quadrupole moments of its cells.
+//
+// The interacting pairs of cells are found by a simultaneous traversal of the tree as a target and as a source.
+// A well-separated pair interacts through the multipole moments of the source cell (mass and quadrupole around the center of mass),
+// seen at the retarded time from the center of the target cell. They accumulate into the local expansion of the field around that
+// center (acceleration with its first and second derivatives), which is then passed down the tree to the bodies. Pairs of leaves
+// too close for this interact body by body.
+//
+// The traversal finding the pairs runs serially. The expansions are passed down serially from the root until the tree splits into
+// `MinSubtreeCount` subtrees, which are then passed down in parallel: each holds a contiguous range of cells and its own bodies.
+//
+// As the retarded time is resolved once per pair of cells, the members of a target cell see the source cell at the same moment,
+// which adds an error proportional to the source's speed and the size of the target cell, on top of the truncation of the expansions.
+//
+class RetardedFmm
+{
+public:
+    const int MinSubtreeCount = 64;
+
+    struct LocalExpansion {
+        vec3       accel;
+        SymMat3    accelGrad;
+        SymTensor3 accelGrad2;
+
+        // Evaluates the expansion at the offset `d` from its center.
+        vec3 accelAt(const vec3& d) const { return accel + accelGrad * d + 0.5f * ((accelGrad2 * d) * d); }
+    };
+
+private:
+    vector<LocalExpansion> _locals;
+    vector<int>            _subtreeRoots;  // The roots of the subtrees passed down in parallel.
+    vector<int>            _splitRoots;
+
+public:
+    void applyGravAccels(NBodySim& sim, const RetardedOctree& octree);
+
+private:
+    void interact(NBodySim& sim, const RetardedOctree& octree, int target_cell_idx, int source_cell_idx);
+    void interactMultipole(const NBodySim& sim, const RetardedOctree& octree, int target_cell_idx, int source_cell_idx);
+    void interactBodies(NBodySim& sim, const RetardedOctree& octree, int target_cell_idx, int source_cell_idx);
+    void passDown(NBodySim& sim, const RetardedOctree& octree, int cell_begin, int cell_end);
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,179 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#pragma once
+
+// This header is shared with the translation units compiled for specific instruction sets. Unlike the others, it must not
+// include "core/basic_types.hpp": inline functions from the STL or GLM emitted in those units could be picked by the linker
+// for the rest of the program, which then would not run on CPUs without these instructions.
+
+#include <cstddef>
+#include <cstdint>
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+#if defined __x86_64__ || defined _M_X64 || defined __i386__ || defined _M_IX86
+#define RETARDED_GRAVITY_KERNEL_X86 1
+#endif
+
+// The targets the kernels process together against each source: the unit of the layout of the light intersection cache and of
+// the flags of `RetardedGravityKernelArgs::horizonSkip`.
+constexpr int RetardedGravityTileSize = 256;
+
+// The Newton steps refining each crossing along the cubic Hermite interpolation of the history, as `NBodySim::HermiteNewtonSteps`.
+constexpr int RetardedGravityHermiteSteps = 2;
+
+// Layout-compatible with `NBodySim::LightIntersectCacheEntry`: the record tag in the low half of a 32-bit lane, alpha in the high one.
+//
+struct RetardedGravityCacheEntry {
+    uint16_t recordTag;
+    uint16_t alphaFixed;
+};
+
+// Layout-compatible with `NBodySim::HistAnchor`.
+//
+struct RetardedGravityHistAnchor {
+    int   originCode[3];
+    float scale;
+    float errorBound;
+};
+
+// Layout-compatible with `NBodySim::TileCrossing`.
+//
+struct RetardedGravityCrossing {
+    float pos[3];
+    float pastTime;
+    float vel[3];
+    float recordRate;
+    int   recordIdx;
+    float recordPos;
+};
+
+// Layout-compatible with `NBodySim::TileReach`.
+//
+struct RetardedGravityTileReach {
+    float center[3];
+    float skipDist2;
+};
+
+// The state of the simulation which the vectorized kernels of the exact solver read and update, as plain arrays.
+//
+struct RetardedGravityKernelArgs {
+    int          sourceCount;  // the first bodies, which attract the others: the rest are tracers
+    int          blockSize;    // of the blocks of sources swept by all the tiles in turn
+    const float* bodyPos;      // xyz of each body
+    const float* bodyMass;     // of each body
+    float*       bodyAccel;    // xyz of each body, accumulated to
+
+    const float*                     histPos;         // xyz of each record slot, in one row of the slots of the levels from `histFirstLevel` on per body; null if compressed
+    const float*                     histStage;       // xyz of each body at the newest record, which the rows of the history do not hold yet; null if compressed and not sampled
+    const float*                     histVel;         // xyz velocity of each record slot, in rows like `histPos`, for the Hermite interpolation; null if linear
+    const float*                     histStageVel;    // xyz velocity of each body at the newest record, as `histStage` in either encoding; null if linear
+    const int16_t*                   histPacked;      // xyz grid offsets of each record slot, in rows like `histPos`, and a spare row; null if not
+    const RetardedGravityHistAnchor* histAnchor;      // the grid of each body, for `histPacked`
+    const size_t*                    histRowBegin;    // the first record slot of the row of each body, counted across the rows
+    const int*                       histFirstLevel;  // the finest level of the row of each body, as in `NBodySim::histFirstLevel`; null if all start at level 0
+    const float*                     histTime;        // of each record slot
+    RetardedGravityCacheEntry*       interCache;      // for each tile of targets, a run of `RetardedGravityTileSize` entries per source body; null unless cached
+    const RetardedGravityCrossing*   tileCrossing;    // for each tile of targets, a row of the crossings of the sources shared by its targets; null unless coherent
+    int                              recordCount;     // of each level, a power of two
+    int                              levelCount;      // of the history, each holding every 2^level-th record, as in `NBodySim::histLevelSlot`
+    const int*                       levelRecStart;   // the oldest record of each level
+    int                              recStart;        // the oldest record still in the history
+    int                              recEnd;          // one past the newest record
+    const int*                       recordGuess;     // the record the search of each cold cache entry starts from, by the light delay, as in `NBodySim::guessCachedRecordIdx`
+    int                              guessBinCount;   // of `recordGuess`
+    const uint8_t*                   horizonSkip;     // for each tile of targets, a row of `sourceCount` flags of the sources out of their reach; null if none
+    const RetardedGravityTileReach*  tileReach;       // for each tile of targets, the sphere out of which no source reaches them, instead of `horizonSkip`; null if none
+
+    float time;
+    float lightSpeedSq;
+    float gravSoftening;
+    float maxSearchJump;
+    float guessScale;     // bins of `recordGuess` per unit of the squared distance
+    float horizonReach2;  // the squared distance from a target beyond which no source can reach it
+};
+
+// The state of the simulation which the vectorized kernels of the Newtonian solver read and update.
+//
+struct NewtonianGravityKernelArgs {
+    int          sourceCount;  // the first bodies, which attract the others
+    const float* bodyPos;      // xyz of each body
+    const float* bodyMass;     // of each body
+    float*       bodyAccel;    // xyz of each body, accumulated to
+    float        gravSoftening;
+};
+
+// The state of the simulation which the vectorized kernels of the analytic solver read and update. The pairs whose extrapolation
+// is not accurate enough are handed to `fallback`, which searches the history of the source from the extrapolated `pastTime`,
+// and returns whether it found the crossing, with the acceleration it exerts on the target in `accel`.
+//
+struct AnalyticGravityKernelArgs {
+    int          sourceCount;    // the first bodies, which attract the others
+    const float* bodyPos;        // xyz of each body
+    const float* bodyVel;        // xyz of each body
+    const float* bodyAccelPrev;  // xyz of each body, which the world lines are extrapolated with
+    const float* bodyJerk;       // of each source, the magnitude
+    const float* bodyMass;       // of each body
+    float*       bodyAccel;      // xyz of each body, accumulated to
+
+    bool (*fallback)(const void* context, int target, int source, float pastTime, float* accel);  // null if none
+    const void* fallbackContext;
+    int         recStart;  // the oldest record still in the history, for counting the pairs which have fallen out of it
+
+    float lightSpeedSq;
+    float lightSpeedInvSq;
+    float gravSoftening;
+    float maxSpeedSq;  // of the sources whose world lines are extrapolated
+    float jerkBound;   // of j²τ⁵, from the tolerance of the error of the force
+};
+
+// The pairs of a run of the analytic kernels which fell back to the search of the history, and those of them which have fallen
+// out of the history, once it has started to drop records.
+//
+struct AnalyticGravityKernelCounts {
+    int64_t fallbackCount;
+    int     outOfWindowCount;
+};
+
+// Accumulates the accelerations of the targets in [targetBegin, targetEnd) exerted by all the other bodies.
+// The kernels handle a group of targets at once against each source, one target per vector lane. They return the number of
+// pairs whose retarded point was older than the history, once it has started to drop records.
+//
+#if RETARDED_GRAVITY_KERNEL_X86
+int applyRetardedGravitySse4(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd);
+int applyRetardedGravityAvx2(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd);
+int applyRetardedGravityAvx512(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd);
+#endif
+
+// Accumulates the accelerations of the targets in [targetBegin, targetEnd) exerted by all the other bodies at their current
+// positions, as in `NBodySim::ForceSolver::Newtonian`, one target per vector lane.
+//
+#if RETARDED_GRAVITY_KERNEL_X86
+void applyNewtonianGravitySse4(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd);
+void applyNewtonianGravityAvx2(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd);
+void applyNewtonianGravityAvx512(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd);
+#endif
+
+// Accumulates the accelerations of the targets in [targetBegin, targetEnd) exerted by all the other bodies at their retarded
+// positions extrapolated from their current motion, as in `NBodySim::ForceSolver::Analytic`, one target per vector lane.
+//
+#if RETARDED_GRAVITY_KERNEL_X86
+AnalyticGravityKernelCounts applyAnalyticGravitySse4(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd);
+AnalyticGravityKernelCounts applyAnalyticGravityAvx2(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd);
+AnalyticGravityKernelCounts applyAnalyticGravityAvx512(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd);
+#endif
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
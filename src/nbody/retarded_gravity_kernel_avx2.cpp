@@ -0,0 +1,95 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "nbody/retarded_gravity_kernel_impl.hpp"
+
+#if RETARDED_GRAVITY_KERNEL_X86
+
+#include <immintrin.h>
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+namespace {
+
+// The AVX2 intrinsics used by the kernel: 8 lanes, with the masks held as float vectors.
+//
+struct SimdAvx2 {
+    constexpr static const int Width = 8;
+
+    using F = __m256;
+    using I = __m256i;
+    using M = __m256;
+
+    static F    set1(float v) { return _mm256_set1_ps(v); }
+    static F    load(const float* ptr) { return _mm256_load_ps(ptr); }
+    static void store(float* ptr, F v) { _mm256_store_ps(ptr, v); }
+    static F    add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F    sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F    mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F    div(F a, F b) { return _mm256_div_ps(a, b); }
+    static F    sqrt(F a) { return _mm256_sqrt_ps(a); }
+    static M    cmplt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static F    select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+
+    static I set1i(int v) { return _mm256_set1_epi32(v); }
+    static I loadi(const int* ptr) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(ptr)); }
+    static I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+    static I subi(I a, I b) { return _mm256_sub_epi32(a, b); }
+    static I muli(I a, I b) { return _mm256_mullo_epi32(a, b); }
+    static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+    static I mini(I a, I b) { return _mm256_min_epi32(a, b); }
+    static I maxi(I a, I b) { return _mm256_max_epi32(a, b); }
+    static M cmplti(I a, I b) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)); }
+    static M cmpeqi(I a, I b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+    static I selecti(M m, I a, I b) { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m)); }
+
+    static I    ori(I a, I b) { return _mm256_or_si256(a, b); }
+    static I    slli(I a, int n) { return _mm256_slli_epi32(a, n); }
+    static I    srli(I a, int n) { return _mm256_srli_epi32(a, n); }
+    static I    srai(I a, int n) { return _mm256_srai_epi32(a, n); }
+    static F    tofloat(I a) { return _mm256_cvtepi32_ps(a); }
+    static I    toint(F a) { return _mm256_cvttps_epi32(a); }
+    static I    loadui(const void* ptr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); }
+    static void storeui(void* ptr, I v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), v); }
+
+    static M    mand(M a, M b) { return _mm256_and_ps(a, b); }
+    static M    mor(M a, M b) { return _mm256_or_ps(a, b); }
+    static M    mandnot(M a, M b) { return _mm256_andnot_ps(a, b); }
+    static bool any(M m) { return _mm256_movemask_ps(m) != 0; }
+
+    static int count(M m)
+    {
+        int n = 0;
+        for (int bits = _mm256_movemask_ps(m); bits != 0; bits &= bits - 1) {
+            ++n;
+        }
+        return n;
+    }
+
+    static F gather(const float* base, I idx) { return _mm256_i32gather_ps(base, idx, 4); }
+    static I gatheri(const char* base, I idx) { return _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), idx, 1); }
+};
+
+}  // namespace
+
+int applyRetardedGravityAvx2(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd) { return applyRetardedGravity<SimdAvx2>(args, targetBegin, targetEnd); }
+
+void applyNewtonianGravityAvx2(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd) { applyNewtonianGravity<SimdAvx2>(args, targetBegin, targetEnd); }
+
+AnalyticGravityKernelCounts applyAnalyticGravityAvx2(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd) { return applyAnalyticGravity<SimdAvx2>(args, targetBegin, targetEnd); }
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+#endif
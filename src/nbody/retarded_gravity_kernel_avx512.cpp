@@ -0,0 +1,95 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "nbody/retarded_gravity_kernel_impl.hpp"
+
+#if RETARDED_GRAVITY_KERNEL_X86
+
+#include <immintrin.h>
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+namespace {
+
+// The AVX-512F intrinsics used by the kernel: 16 lanes, with the masks held in mask registers.
+//
+struct SimdAvx512 {
+    constexpr static const int Width = 16;
+
+    using F = __m512;
+    using I = __m512i;
+    using M = __mmask16;
+
+    static F    set1(float v) { return _mm512_set1_ps(v); }
+    static F    load(const float* ptr) { return _mm512_load_ps(ptr); }
+    static void store(float* ptr, F v) { _mm512_store_ps(ptr, v); }
+    static F    add(F a, F b) { return _mm512_add_ps(a, b); }
+    static F    sub(F a, F b) { return _mm512_sub_ps(a, b); }
+    static F    mul(F a, F b) { return _mm512_mul_ps(a, b); }
+    static F    div(F a, F b) { return _mm512_div_ps(a, b); }
+    static F    sqrt(F a) { return _mm512_sqrt_ps(a); }
+    static M    cmplt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static F    select(M m, F a, F b) { return _mm512_mask_blend_ps(m, b, a); }
+
+    static I set1i(int v) { return _mm512_set1_epi32(v); }
+    static I loadi(const int* ptr) { return _mm512_load_si512(ptr); }
+    static I addi(I a, I b) { return _mm512_add_epi32(a, b); }
+    static I subi(I a, I b) { return _mm512_sub_epi32(a, b); }
+    static I muli(I a, I b) { return _mm512_mullo_epi32(a, b); }
+    static I andi(I a, I b) { return _mm512_and_si512(a, b); }
+    static I mini(I a, I b) { return _mm512_min_epi32(a, b); }
+    static I maxi(I a, I b) { return _mm512_max_epi32(a, b); }
+    static M cmplti(I a, I b) { return _mm512_cmplt_epi32_mask(a, b); }
+    static M cmpeqi(I a, I b) { return _mm512_cmpeq_epi32_mask(a, b); }
+    static I selecti(M m, I a, I b) { return _mm512_mask_blend_epi32(m, b, a); }
+
+    static I    ori(I a, I b) { return _mm512_or_si512(a, b); }
+    static I    slli(I a, int n) { return _mm512_slli_epi32(a, n); }
+    static I    srli(I a, int n) { return _mm512_srli_epi32(a, n); }
+    static I    srai(I a, int n) { return _mm512_srai_epi32(a, n); }
+    static F    tofloat(I a) { return _mm512_cvtepi32_ps(a); }
+    static I    toint(F a) { return _mm512_cvttps_epi32(a); }
+    static I    loadui(const void* ptr) { return _mm512_loadu_si512(ptr); }
+    static void storeui(void* ptr, I v) { _mm512_storeu_si512(ptr, v); }
+
+    static M    mand(M a, M b) { return static_cast<M>(a & b); }
+    static M    mor(M a, M b) { return static_cast<M>(a | b); }
+    static M    mandnot(M a, M b) { return static_cast<M>(~a & b); }
+    static bool any(M m) { return m != 0; }
+
+    static int count(M m)
+    {
+        int n = 0;
+        for (int bits = m; bits != 0; bits &= bits - 1) {
+            ++n;
+        }
+        return n;
+    }
+
+    static F gather(const float* base, I idx) { return _mm512_i32gather_ps(idx, base, 4); }
+    static I gatheri(const char* base, I idx) { return _mm512_i32gather_epi32(idx, base, 1); }
+};
+
+}  // namespace
+
+int applyRetardedGravityAvx512(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd) { return applyRetardedGravity<SimdAvx512>(args, targetBegin, targetEnd); }
+
+void applyNewtonianGravityAvx512(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd) { applyNewtonianGravity<SimdAvx512>(args, targetBegin, targetEnd); }
+
+AnalyticGravityKernelCounts applyAnalyticGravityAvx512(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd) { return applyAnalyticGravity<SimdAvx512>(args, targetBegin, targetEnd); }
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+#endif
@@ -0,0 +1,692 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#pragma once
+
+#include "nbody/retarded_gravity_kernel.hpp"
+
+#include <cassert>
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// Squared distance between the points `a` and `b`, as in `glm::distance2(a, b)`.
+//
+template<typename Simd> typename Simd::F distance2(typename Simd::F a_x, typename Simd::F a_y, typename Simd::F a_z, typename Simd::F b_x, typename Simd::F b_y, typename Simd::F b_z)
+{
+    const auto d_x = Simd::sub(b_x, a_x);
+    const auto d_y = Simd::sub(b_y, a_y);
+    const auto d_z = Simd::sub(b_z, a_z);
+    return Simd::add(Simd::add(Simd::mul(d_x, d_x), Simd::mul(d_y, d_y)), Simd::mul(d_z, d_z));
+}
+
+// Whether a source at `source_pos` (xyz) is out of the sphere of a tile, as in `NBodySim::outOfTileReach`. It is a template only
+// to stay local to the translation unit of each instruction set, like the kernels.
+//
+template<typename Simd> bool outOfTileReach(const RetardedGravityTileReach& tile_reach, const float* source_pos)
+{
+    const float d_x = source_pos[0] - tile_reach.center[0];
+    const float d_y = source_pos[1] - tile_reach.center[1];
+    const float d_z = source_pos[2] - tile_reach.center[2];
+    return d_x * d_x + d_y * d_y + d_z * d_z > tile_reach.skipDist2;
+}
+
+// The vectorized counterpart of `NBodySim::applyGravAccel` and `NBodySim::findRetardedPos`, written once against the thin
+// wrapper `Simd` of the intrinsics of an instruction set. Each translation unit compiled for an instruction set instantiates it.
+//
+// The lanes hold a group of consecutive targets, which face the same source: their cache entries are adjacent in the row of
+// that source, and the positions along its world line are gathered from a single history row. Each lane searches the history
+// on its own, jumping and bisecting between the records as the scalar search does, until all the lanes have found their crossing
+// of the light cone (or have fallen out of the recorded history).
+//
+// The history may hold coarser levels of older records: the lanes step along the chain of the levels as the scalar search does,
+// with the levels of the records found by comparing them against the oldest record of each level. The rows of the sources
+// sampled from a coarser level start at that level, and their chains skip the finer ones, as in `NBodySim::adaptiveSampling`.
+//
+// The targets are processed in tiles, whose positions and accelerations stay in the L1 cache while the tile sweeps the sources.
+// The cache entries of a tile are contiguous for each source, and the runs of the sources follow each other. The sources are
+// swept in blocks, each by all the tiles in turn, so that the history rows of a block stay in the L2 cache for the next tile.
+// The arithmetic and the order of the summation over the sources follow the scalar code, so the results are identical.
+// The sources flagged out of the reach of a tile are skipped, as in `NBodySim::horizonSkipping`, or those out of its sphere in the
+// cacheless search. In the coherent search, the lanes start from the guesses of the crossings shared by the tile, as in
+// `NBodySim::exactSearch`, and in the cacheless one from the guesses of the cold cache entries: there is no cache in either.
+// `Packed` selects the compressed position history, decoded as in `NBodySim::decodeHistPos`; the full one, and either with
+// the adaptive sampling, reads the newest record from its staging row, as in `NBodySim::StagedHistRow`. With the velocities of the records, the crossings found on
+// the chords are refined along the cubic Hermite segments, as in `NBodySim::findRetardedPosIn`. Returns the number of the pairs
+// which have fallen out of the history, once it has started to drop records.
+//
+template<typename Simd, bool Packed> int applyRetardedGravityTiles(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd)
+{
+    using F = typename Simd::F;
+    using I = typename Simd::I;
+    using M = typename Simd::M;
+
+    constexpr int Width    = Simd::Width;
+    constexpr int TileSize = RetardedGravityTileSize;
+    static_assert(TileSize % Width == 0);
+
+    assert((args.recordCount & (args.recordCount - 1)) == 0);
+    assert(args.recEnd > args.recStart);
+    assert(targetBegin % TileSize == 0);
+
+    const I rec_start   = Simd::set1i(args.recStart);
+    const I rec_end     = Simd::set1i(args.recEnd);
+    const I rec_newest  = Simd::set1i(args.recEnd - 1);
+    const I rec_last    = Simd::set1i(args.recEnd - 2);
+    const I record_mask = Simd::set1i(args.recordCount - 1);
+    const I tag_mask    = Simd::set1i(0xffff);
+    const I zero_i      = Simd::set1i(0);
+    const I minus_one_i = Simd::set1i(-1);
+    const I one_i       = Simd::set1i(1);
+    const I three_i     = Simd::set1i(3);
+    const I six_i       = Simd::set1i(6);
+    const F zero        = Simd::set1(0.0f);
+    const F one         = Simd::set1(1.0f);
+    const F half        = Simd::set1(0.5f);
+    const F two         = Simd::set1(2.0f);
+    const F three       = Simd::set1(3.0f);
+    const F four        = Simd::set1(4.0f);
+    const F alpha_scale = Simd::set1(65535.0f);
+    const F time        = Simd::set1(args.time);
+    const F c2          = Simd::set1(args.lightSpeedSq);
+    const F softening   = Simd::set1(args.gravSoftening);
+    const F epsilon     = Simd::set1(0.00001f);
+    const F max_jump    = Simd::set1(args.maxSearchJump);
+    const F guess_scale = Simd::set1(args.guessScale);
+    const F guess_max   = Simd::set1((float)(args.guessBinCount - 1));
+    const F reach2      = Simd::set1(args.horizonReach2);
+
+    int outOfWindowCount = 0;
+
+    alignas(64) float tile_x[TileSize];
+    alignas(64) float tile_y[TileSize];
+    alignas(64) float tile_z[TileSize];
+    alignas(64) int   tile_target[TileSize];
+    alignas(64) float tile_accel_x[TileSize];
+    alignas(64) float tile_accel_y[TileSize];
+    alignas(64) float tile_accel_z[TileSize];
+
+    for (int block_begin = 0; block_begin < args.sourceCount; block_begin += args.blockSize) {
+        const int block_end = (args.sourceCount - block_begin < args.blockSize) ? args.sourceCount : block_begin + args.blockSize;
+
+        for (int tile_begin = targetBegin; tile_begin < targetEnd; tile_begin += TileSize) {
+            const int tile_count = (targetEnd - tile_begin < TileSize) ? targetEnd - tile_begin : TileSize;
+
+            // The lanes past the end of the tile repeat its first target and stay inactive.
+            for (int i = 0; i < TileSize; ++i) {
+                const int it    = tile_begin + (i < tile_count ? i : 0);
+                tile_x[i]       = args.bodyPos[3 * it + 0];
+                tile_y[i]       = args.bodyPos[3 * it + 1];
+                tile_z[i]       = args.bodyPos[3 * it + 2];
+                tile_target[i]  = (i < tile_count) ? it : -1;
+                tile_accel_x[i] = args.bodyAccel[3 * it + 0];
+                tile_accel_y[i] = args.bodyAccel[3 * it + 1];
+                tile_accel_z[i] = args.bodyAccel[3 * it + 2];
+            }
+
+            const uint8_t* const             tile_skip      = args.horizonSkip ? args.horizonSkip + (long long)(tile_begin / TileSize) * args.sourceCount : nullptr;
+            RetardedGravityCacheEntry* const tile_entries   = args.interCache ? args.interCache + (long long)(tile_begin / TileSize) * args.sourceCount * TileSize : nullptr;
+            const RetardedGravityCrossing*   tile_crossings = args.tileCrossing ? args.tileCrossing + (long long)(tile_begin / TileSize) * args.sourceCount : nullptr;
+            const RetardedGravityTileReach*  tile_reach     = args.tileReach ? args.tileReach + tile_begin / TileSize : nullptr;
+
+            for (int is = block_begin; is < block_end; ++is) {
+                RetardedGravityCacheEntry* const row_entries = tile_entries ? tile_entries + (long long)is * TileSize : nullptr;
+                const RetardedGravityCrossing*   crossing    = tile_crossings ? tile_crossings + is : nullptr;
+
+                // No position recorded by the source can reach the tile. The entries end at the oldest record, as the searches would.
+                if ((tile_skip && tile_skip[is]) || (tile_reach && outOfTileReach<Simd>(*tile_reach, args.bodyPos + 3 * is))) {
+                    for (int i = 0; i < tile_count && row_entries; ++i) {
+                        row_entries[i].recordTag = (uint16_t)(args.recStart & 0xffff);
+                    }
+                    if (args.recStart > 0) {
+                        outOfWindowCount += tile_count - (is >= tile_begin && is < tile_begin + tile_count);
+                    }
+                    continue;
+                }
+
+                const F mass  = Simd::set1(args.bodyMass[is]);
+                const I s_idx = Simd::set1i(is);
+                const F s_x   = Simd::set1(args.bodyPos[3 * is + 0]);
+                const F s_y   = Simd::set1(args.bodyPos[3 * is + 1]);
+                const F s_z   = Simd::set1(args.bodyPos[3 * is + 2]);
+
+                // The row of the source holds the levels from its finest one, whose slots start the row. The finer levels hold
+                // only the newest record for it, as in `NBodySim::levelOldestRecordIdx`.
+                const long long row_begin   = (long long)args.histRowBegin[is];
+                const int       first_level = args.histFirstLevel ? args.histFirstLevel[is] : 0;
+                const I         first_slot  = Simd::set1i(first_level * args.recordCount);
+                const auto      levelStart  = [&](int level) { return (level < first_level) ? rec_newest : Simd::set1i(args.levelRecStart[level]); };
+
+                // The slots of the records, as in `NBodySim::histRecordSlot`, and their offsets in the row. The lanes whose
+                // slots are not in the row read its first one, and take the staged record or end.
+                const auto recordSlot = [&](I idx) {
+                    I slot = Simd::andi(idx, record_mask);
+                    for (int level = 1; level < args.levelCount; ++level) {
+                        const M older = Simd::cmplti(idx, levelStart(level - 1));
+                        slot          = Simd::selecti(older, Simd::addi(Simd::set1i(level * args.recordCount), Simd::andi(Simd::srli(idx, level), record_mask)), slot);
+                    }
+                    return slot;
+                };
+                const auto rowSlot = [&](I slot) { return Simd::maxi(Simd::subi(slot, first_slot), zero_i); };
+
+                // The newest position of the source, staged out of its history row.
+                F staged_x = zero;
+                F staged_y = zero;
+                F staged_z = zero;
+                if (args.histStage) {
+                    staged_x = Simd::set1(args.histStage[3 * is + 0]);
+                    staged_y = Simd::set1(args.histStage[3 * is + 1]);
+                    staged_z = Simd::set1(args.histStage[3 * is + 2]);
+                }
+                F staged_vel_x = zero;
+                F staged_vel_y = zero;
+                F staged_vel_z = zero;
+                if (args.histVel) {
+                    staged_vel_x = Simd::set1(args.histStageVel[3 * is + 0]);
+                    staged_vel_y = Simd::set1(args.histStageVel[3 * is + 1]);
+                    staged_vel_z = Simd::set1(args.histStageVel[3 * is + 2]);
+                }
+
+                // Gathers the positions of the source at the record slots of the lanes.
+                const auto loadHistPos = [&](I slot, F& x, F& y, F& z) {
+                    if constexpr (Packed) {
+                        // A record takes 6 bytes: the 4 bytes at its start hold x and y, and the 4 bytes after them hold z and the next x.
+                        const char* const                s_packed_arr = reinterpret_cast<const char*>(args.histPacked + row_begin * 3);
+                        const RetardedGravityHistAnchor& anchor       = args.histAnchor[is];
+
+                        const I off   = Simd::muli(rowSlot(slot), six_i);
+                        const I xy    = Simd::gatheri(s_packed_arr, off);
+                        const I zw    = Simd::gatheri(s_packed_arr + 4, off);
+                        const F scale = Simd::set1(anchor.scale);
+                        x             = Simd::mul(Simd::tofloat(Simd::addi(Simd::srai(Simd::slli(xy, 16), 16), Simd::set1i(anchor.originCode[0]))), scale);
+                        y             = Simd::mul(Simd::tofloat(Simd::addi(Simd::srai(xy, 16), Simd::set1i(anchor.originCode[1]))), scale);
+                        z             = Simd::mul(Simd::tofloat(Simd::addi(Simd::srai(Simd::slli(zw, 16), 16), Simd::set1i(anchor.originCode[2]))), scale);
+                    } else {
+                        const float* const s_pos_arr = args.histPos + row_begin * 3;
+
+                        const I off = Simd::muli(rowSlot(slot), three_i);
+                        x           = Simd::gather(s_pos_arr + 0, off);
+                        y           = Simd::gather(s_pos_arr + 1, off);
+                        z           = Simd::gather(s_pos_arr + 2, off);
+                    }
+                };
+
+                for (int ig = 0; ig < tile_count; ig += Width) {
+                    const F t_x   = Simd::load(tile_x + ig);
+                    const F t_y   = Simd::load(tile_y + ig);
+                    const F t_z   = Simd::load(tile_z + ig);
+                    const I t_idx = Simd::loadi(tile_target + ig);
+
+                    // The lanes past the end of a partial tile hold its padding entries.
+                    RetardedGravityCacheEntry* const lane_entries = row_entries ? row_entries + ig : nullptr;
+
+                    I hist_record_idx = minus_one_i;
+                    F hist_alpha      = zero;
+                    if (lane_entries) {
+                        // Unpack the entries as in `NBodySim::decodeCacheEntry`. The low 16 bits of the difference do not depend on alpha.
+                        const I packed_entries = Simd::loadui(lane_entries);
+                        hist_record_idx        = Simd::subi(rec_newest, Simd::andi(Simd::subi(rec_newest, packed_entries), tag_mask));
+                        hist_alpha             = Simd::div(Simd::tofloat(Simd::srli(packed_entries, 16)), alpha_scale);
+                    } else if (crossing && crossing->recordIdx >= 0) {
+                        // Guess from the crossing shared by the tile, as in `NBodySim::guessTileRecordIdx`.
+                        const F vel_x      = Simd::set1(crossing->vel[0]);
+                        const F vel_y      = Simd::set1(crossing->vel[1]);
+                        const F vel_z      = Simd::set1(crossing->vel[2]);
+                        const F off_x      = Simd::sub(t_x, Simd::set1(crossing->pos[0]));
+                        const F off_y      = Simd::sub(t_y, Simd::set1(crossing->pos[1]));
+                        const F off_z      = Simd::sub(t_z, Simd::set1(crossing->pos[2]));
+                        const F off_len2   = Simd::add(Simd::add(Simd::mul(off_x, off_x), Simd::mul(off_y, off_y)), Simd::mul(off_z, off_z));
+                        const F off_vel    = Simd::add(Simd::add(Simd::mul(off_x, vel_x), Simd::mul(off_y, vel_y)), Simd::mul(off_z, vel_z));
+                        const F weight     = Simd::sub(Simd::mul(c2, Simd::set1(crossing->pastTime)), off_len2);
+                        const F slope      = Simd::add(c2, Simd::mul(two, off_vel));
+                        const F shift      = Simd::select(Simd::cmplt(zero, slope), Simd::div(weight, slope), zero);
+                        const F record_off = Simd::add(Simd::set1(crossing->recordPos), Simd::mul(shift, Simd::set1(crossing->recordRate)));
+                        const F min_off    = Simd::set1((float)(args.recStart - crossing->recordIdx));
+                        const F max_off    = Simd::set1((float)(args.recEnd - 2 - crossing->recordIdx));
+                        const F capped_off = Simd::select(Simd::cmplt(max_off, record_off), max_off, record_off);
+                        const F guess_off  = Simd::select(Simd::cmplt(min_off, capped_off), capped_off, min_off);
+                        const I trunc_off  = Simd::toint(guess_off);
+                        const I floor_off  = Simd::selecti(Simd::cmplt(guess_off, Simd::tofloat(trunc_off)), Simd::subi(trunc_off, one_i), trunc_off);
+                        hist_record_idx    = Simd::addi(Simd::set1i(crossing->recordIdx), floor_off);
+                    }
+
+                    // The cold entries start from the record guessed from the current distance, as in `NBodySim::applyGravAccel`.
+                    const F dist2_now = distance2<Simd>(t_x, t_y, t_z, s_x, s_y, s_z);
+                    if (const M cold = Simd::cmplti(hist_record_idx, rec_start); Simd::any(cold)) {
+                        const F guess_bin = Simd::mul(dist2_now, guess_scale);
+                        const I guess_off = Simd::slli(Simd::toint(Simd::select(Simd::cmplt(guess_max, guess_bin), guess_max, guess_bin)), 2);
+                        hist_record_idx   = Simd::selecti(cold, Simd::gatheri(reinterpret_cast<const char*>(args.recordGuess), guess_off), hist_record_idx);
+                    }
+
+                    F accel_x = zero;
+                    F accel_y = zero;
+                    F accel_z = zero;
+
+                    // The newest record known to be older than the crossing, and the oldest one known to be newer.
+                    I bracket_lo = minus_one_i;
+                    I bracket_hi = rec_end;
+
+                    M active = Simd::mandnot(Simd::cmpeqi(t_idx, s_idx), Simd::cmplti(minus_one_i, t_idx));
+
+                    // The targets out of the causal horizon end at the oldest record, as their searches would.
+                    const M beyond  = Simd::mand(active, Simd::cmplt(reach2, dist2_now));
+                    hist_record_idx = Simd::selecti(beyond, rec_start, hist_record_idx);
+                    active          = Simd::mandnot(beyond, active);
+                    if (args.recStart > 0) {
+                        outOfWindowCount += Simd::count(beyond);
+                    }
+                    while (Simd::any(active)) {
+                        // Clamp to the oldest record.
+                        hist_record_idx = Simd::selecti(Simd::mand(active, Simd::cmplti(hist_record_idx, rec_start)), rec_start, hist_record_idx);
+
+                        // The step between the records of the level, and the oldest record of the previous one.
+                        I s0_step = one_i;
+                        I s1_cap  = rec_end;
+                        for (int level = 1; level < args.levelCount; ++level) {
+                            const I prev_start = levelStart(level - 1);
+                            const M older      = Simd::cmplti(hist_record_idx, prev_start);
+                            s0_step            = Simd::selecti(older, Simd::set1i(1 << level), s0_step);
+                            s1_cap             = Simd::selecti(older, prev_start, s1_cap);
+                        }
+
+                        // Round down to the previous record of the level.
+                        hist_record_idx = Simd::selecti(active, Simd::andi(hist_record_idx, Simd::subi(zero_i, s0_step)), hist_record_idx);
+
+                        const I s0_idx = hist_record_idx;
+                        const I s1_idx = Simd::mini(Simd::addi(s0_idx, s0_step), s1_cap);
+
+                        // The crossing is newer than the newest record.
+                        active = Simd::mand(active, Simd::cmplti(s1_idx, rec_end));
+
+                        const I s0_slot = recordSlot(s0_idx);
+                        const I s1_slot = recordSlot(s1_idx);
+
+                        F s0_x, s0_y, s0_z, s1_x, s1_y, s1_z;
+                        loadHistPos(s0_slot, s0_x, s0_y, s0_z);
+                        loadHistPos(s1_slot, s1_x, s1_y, s1_z);
+                        if (args.histStage) {
+                            // Only the newer end of a segment may be the newest record.
+                            const M s1_staged = Simd::cmpeqi(s1_idx, rec_newest);
+                            s1_x              = Simd::select(s1_staged, staged_x, s1_x);
+                            s1_y              = Simd::select(s1_staged, staged_y, s1_y);
+                            s1_z              = Simd::select(s1_staged, staged_z, s1_z);
+                        }
+
+                        const F s0_past_time = Simd::sub(time, Simd::gather(args.histTime, s0_slot));
+                        const F s1_past_time = Simd::sub(time, Simd::gather(args.histTime, s1_slot));
+                        const F s0_weight    = Simd::sub(Simd::mul(c2, s0_past_time), distance2<Simd>(t_x, t_y, t_z, s0_x, s0_y, s0_z));
+                        const F s1_weight    = Simd::sub(Simd::mul(c2, s1_past_time), distance2<Simd>(t_x, t_y, t_z, s1_x, s1_y, s1_z));
+
+                        // The crossing is older: step back, within the level or to the next one. Or newer: step forward.
+                        const M step_back     = Simd::mand(active, Simd::cmplt(s0_weight, zero));
+                        const M no_record     = Simd::mand(step_back, Simd::cmpeqi(s0_idx, rec_start));
+                        const M moved_back    = Simd::mandnot(no_record, step_back);
+                        const M not_back      = Simd::mandnot(step_back, active);
+                        const M moved_forward = Simd::mand(not_back, Simd::cmplt(zero, s1_weight));
+                        const M found         = Simd::mandnot(moved_forward, not_back);
+                        if (args.recStart > 0) {
+                            outOfWindowCount += Simd::count(no_record);
+                        }
+
+                        // The root of the weight along the segment, as in `NBodySim::findRetardedPos`.
+                        const F seg_x     = Simd::sub(s1_x, s0_x);
+                        const F seg_y     = Simd::sub(s1_y, s0_y);
+                        const F seg_z     = Simd::sub(s1_z, s0_z);
+                        const F seg_len2  = Simd::add(Simd::add(Simd::mul(seg_x, seg_x), Simd::mul(seg_y, seg_y)), Simd::mul(seg_z, seg_z));
+                        const F r0_x      = Simd::sub(t_x, s0_x);
+                        const F r0_y      = Simd::sub(t_y, s0_y);
+                        const F r0_z      = Simd::sub(t_z, s0_z);
+                        const F r0_seg    = Simd::add(Simd::add(Simd::mul(r0_x, seg_x), Simd::mul(r0_y, seg_y)), Simd::mul(r0_z, seg_z));
+                        const F b         = Simd::add(Simd::mul(c2, Simd::sub(s1_past_time, s0_past_time)), Simd::mul(two, r0_seg));
+                        const F sqrt_disc = Simd::sqrt(Simd::add(Simd::mul(b, b), Simd::mul(Simd::mul(four, seg_len2), s0_weight)));
+                        const F beta_pos  = Simd::div(Simd::add(b, sqrt_disc), Simd::add(Simd::mul(two, seg_len2), epsilon));
+                        const F beta_neg  = Simd::div(Simd::mul(two, s0_weight), Simd::add(Simd::sub(sqrt_disc, b), epsilon));
+                        const F beta_raw  = Simd::select(Simd::cmplt(zero, b), beta_pos, beta_neg);
+                        const F beta      = Simd::select(Simd::cmplt(beta_raw, zero), zero, Simd::select(Simd::cmplt(one, beta_raw), one, beta_raw));
+
+                        F alpha = beta;
+                        F sb_x  = Simd::add(s0_x, Simd::mul(seg_x, beta));
+                        F sb_y  = Simd::add(s0_y, Simd::mul(seg_y, beta));
+                        F sb_z  = Simd::add(s0_z, Simd::mul(seg_z, beta));
+                        if (args.histVel && Simd::any(found)) {
+                            // Refine the root along the cubic Hermite segment, as in `NBodySim::findRetardedPosIn`.
+                            const float* const s_vel_arr = args.histVel + row_begin * 3;
+
+                            const I s0_off    = Simd::muli(rowSlot(s0_slot), three_i);
+                            const I s1_off    = Simd::muli(rowSlot(s1_slot), three_i);
+                            const M s1_staged = Simd::cmpeqi(s1_idx, rec_newest);
+                            const F seg_time  = Simd::sub(s0_past_time, s1_past_time);
+                            const F tan0_x    = Simd::mul(Simd::gather(s_vel_arr + 0, s0_off), seg_time);
+                            const F tan0_y    = Simd::mul(Simd::gather(s_vel_arr + 1, s0_off), seg_time);
+                            const F tan0_z    = Simd::mul(Simd::gather(s_vel_arr + 2, s0_off), seg_time);
+                            const F tan1_x    = Simd::mul(Simd::select(s1_staged, staged_vel_x, Simd::gather(s_vel_arr + 0, s1_off)), seg_time);
+                            const F tan1_y    = Simd::mul(Simd::select(s1_staged, staged_vel_y, Simd::gather(s_vel_arr + 1, s1_off)), seg_time);
+                            const F tan1_z    = Simd::mul(Simd::select(s1_staged, staged_vel_z, Simd::gather(s_vel_arr + 2, s1_off)), seg_time);
+                            const F coef2_x   = Simd::sub(Simd::sub(Simd::mul(three, seg_x), Simd::mul(two, tan0_x)), tan1_x);
+                            const F coef2_y   = Simd::sub(Simd::sub(Simd::mul(three, seg_y), Simd::mul(two, tan0_y)), tan1_y);
+                            const F coef2_z   = Simd::sub(Simd::sub(Simd::mul(three, seg_z), Simd::mul(two, tan0_z)), tan1_z);
+                            const F coef3_x   = Simd::sub(Simd::add(tan0_x, tan1_x), Simd::mul(two, seg_x));
+                            const F coef3_y   = Simd::sub(Simd::add(tan0_y, tan1_y), Simd::mul(two, seg_y));
+                            const F coef3_z   = Simd::sub(Simd::add(tan0_z, tan1_z), Simd::mul(two, seg_z));
+
+                            // The position along the segment and its derivative by alpha, in one coordinate.
+                            const auto hermitePos = [&](F a, F p0, F t0, F q2, F q3) { return Simd::add(p0, Simd::mul(a, Simd::add(t0, Simd::mul(a, Simd::add(q2, Simd::mul(a, q3)))))); };
+                            const auto hermiteTan = [&](F a, F t0, F q2, F q3) { return Simd::add(t0, Simd::mul(a, Simd::add(Simd::mul(two, q2), Simd::mul(Simd::mul(three, a), q3)))); };
+
+                            for (int i = 0; i < RetardedGravityHermiteSteps; ++i) {
+                                const F off_x   = Simd::sub(t_x, hermitePos(alpha, s0_x, tan0_x, coef2_x, coef3_x));
+                                const F off_y   = Simd::sub(t_y, hermitePos(alpha, s0_y, tan0_y, coef2_y, coef3_y));
+                                const F off_z   = Simd::sub(t_z, hermitePos(alpha, s0_z, tan0_z, coef2_z, coef3_z));
+                                const F tng_x   = hermiteTan(alpha, tan0_x, coef2_x, coef3_x);
+                                const F tng_y   = hermiteTan(alpha, tan0_y, coef2_y, coef3_y);
+                                const F tng_z   = hermiteTan(alpha, tan0_z, coef2_z, coef3_z);
+                                const F off_len = Simd::add(Simd::add(Simd::mul(off_x, off_x), Simd::mul(off_y, off_y)), Simd::mul(off_z, off_z));
+                                const F off_tng = Simd::add(Simd::add(Simd::mul(off_x, tng_x), Simd::mul(off_y, tng_y)), Simd::mul(off_z, tng_z));
+                                const F weight  = Simd::sub(Simd::mul(c2, Simd::sub(s0_past_time, Simd::mul(seg_time, alpha))), off_len);
+                                const F slope   = Simd::sub(Simd::mul(two, off_tng), Simd::mul(c2, seg_time));
+                                const F stepped = Simd::sub(alpha, Simd::div(weight, slope));
+                                const F clamped = Simd::select(Simd::cmplt(stepped, zero), zero, Simd::select(Simd::cmplt(one, stepped), one, stepped));
+                                alpha           = Simd::select(Simd::cmplt(slope, zero), clamped, alpha);
+                            }
+                            sb_x = hermitePos(alpha, s0_x, tan0_x, coef2_x, coef3_x);
+                            sb_y = hermitePos(alpha, s0_y, tan0_y, coef2_y, coef3_y);
+                            sb_z = hermitePos(alpha, s0_z, tan0_z, coef2_z, coef3_z);
+                        }
+
+                        // Attract the targets which have found the retarded position of the source, as in `NBodySim::gravAccel`.
+                        const F dist2 = distance2<Simd>(sb_x, sb_y, sb_z, t_x, t_y, t_z);
+                        const F denom = Simd::add(Simd::mul(dist2, Simd::sqrt(dist2)), softening);
+                        accel_x       = Simd::select(found, Simd::mul(Simd::div(Simd::sub(sb_x, t_x), denom), mass), accel_x);
+                        accel_y       = Simd::select(found, Simd::mul(Simd::div(Simd::sub(sb_y, t_y), denom), mass), accel_y);
+                        accel_z       = Simd::select(found, Simd::mul(Simd::div(Simd::sub(sb_z, t_z), denom), mass), accel_z);
+                        hist_alpha    = Simd::select(found, alpha, hist_alpha);
+
+                        // Bisect the bracket once both of its ends are known, or jump by the root of the chord through the weights.
+                        bracket_hi = Simd::selecti(moved_back, s0_idx, bracket_hi);
+                        bracket_lo = Simd::selecti(moved_forward, s1_idx, bracket_lo);
+
+                        const I bisect_idx   = Simd::srli(Simd::addi(bracket_lo, bracket_hi), 1);
+                        const M falling      = Simd::cmplt(s1_weight, s0_weight);
+                        const F back_chord   = Simd::div(s0_weight, Simd::sub(s1_weight, s0_weight));
+                        const F back_jump    = Simd::select(falling, Simd::select(Simd::cmplt(max_jump, back_chord), max_jump, back_chord), zero);
+                        const F fwd_chord    = Simd::div(s1_weight, Simd::sub(s0_weight, s1_weight));
+                        const F fwd_jump     = Simd::select(falling, Simd::select(Simd::cmplt(max_jump, fwd_chord), max_jump, fwd_chord), zero);
+                        const I back_idx     = Simd::subi(s0_idx, Simd::muli(Simd::addi(one_i, Simd::toint(back_jump)), s0_step));
+                        const I fwd_idx      = Simd::maxi(s1_idx, Simd::mini(Simd::addi(s1_idx, Simd::muli(Simd::toint(fwd_jump), Simd::subi(s1_idx, s0_idx))), rec_last));
+                        const I back_next    = Simd::selecti(Simd::cmplti(minus_one_i, bracket_lo), bisect_idx, back_idx);
+                        const I forward_next = Simd::selecti(Simd::cmplti(bracket_hi, rec_end), bisect_idx, fwd_idx);
+                        hist_record_idx      = Simd::selecti(moved_back, back_next, Simd::selecti(moved_forward, forward_next, hist_record_idx));
+
+                        active = Simd::mor(moved_back, moved_forward);
+                    }
+
+                    Simd::store(tile_accel_x + ig, Simd::add(Simd::load(tile_accel_x + ig), accel_x));
+                    Simd::store(tile_accel_y + ig, Simd::add(Simd::load(tile_accel_y + ig), accel_y));
+                    Simd::store(tile_accel_z + ig, Simd::add(Simd::load(tile_accel_z + ig), accel_z));
+
+                    // Pack the entries as in `NBodySim::encodeCacheEntry`.
+                    if (lane_entries) {
+                        const I alpha_fixed = Simd::toint(Simd::add(Simd::mul(hist_alpha, alpha_scale), half));
+                        Simd::storeui(lane_entries, Simd::ori(Simd::andi(hist_record_idx, tag_mask), Simd::slli(alpha_fixed, 16)));
+                    }
+                }
+            }
+
+            for (int i = 0; i < tile_count; ++i) {
+                args.bodyAccel[3 * (tile_begin + i) + 0] = tile_accel_x[i];
+                args.bodyAccel[3 * (tile_begin + i) + 1] = tile_accel_y[i];
+                args.bodyAccel[3 * (tile_begin + i) + 2] = tile_accel_z[i];
+            }
+        }
+    }
+
+    return outOfWindowCount;
+}
+
+template<typename Simd> int applyRetardedGravity(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd)
+{
+    if (args.histPacked) {
+        return applyRetardedGravityTiles<Simd, true>(args, targetBegin, targetEnd);
+    }
+    return applyRetardedGravityTiles<Simd, false>(args, targetBegin, targetEnd);
+}
+
+// The vectorized counterpart of the scalar loop of `NBodySim::applyNewtonianGravAccels`. The lanes hold a group of consecutive
+// targets, whose accelerations stay in registers while they sum all the sources in their order, each broadcast to all the lanes.
+// The lane of the target itself sees the source with no mass. The arithmetic follows `NBodySim::gravAccel`, so the results are
+// identical to the scalar loop.
+//
+template<typename Simd> void applyNewtonianGravity(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd)
+{
+    using F = typename Simd::F;
+    using I = typename Simd::I;
+
+    constexpr int Width = Simd::Width;
+
+    const F zero      = Simd::set1(0.0f);
+    const F softening = Simd::set1(args.gravSoftening);
+
+    alignas(64) float group_x[Width];
+    alignas(64) float group_y[Width];
+    alignas(64) float group_z[Width];
+    alignas(64) int   group_target[Width];
+    alignas(64) float group_accel_x[Width];
+    alignas(64) float group_accel_y[Width];
+    alignas(64) float group_accel_z[Width];
+
+    for (int group_begin = targetBegin; group_begin < targetEnd; group_begin += Width) {
+        const int group_count = (targetEnd - group_begin < Width) ? targetEnd - group_begin : Width;
+
+        // The lanes past the end of the range repeat its first target, and are not stored.
+        for (int i = 0; i < Width; ++i) {
+            const int it    = group_begin + (i < group_count ? i : 0);
+            group_x[i]      = args.bodyPos[3 * it + 0];
+            group_y[i]      = args.bodyPos[3 * it + 1];
+            group_z[i]      = args.bodyPos[3 * it + 2];
+            group_target[i] = it;
+        }
+
+        const F t_x     = Simd::load(group_x);
+        const F t_y     = Simd::load(group_y);
+        const F t_z     = Simd::load(group_z);
+        const I t_idx   = Simd::loadi(group_target);
+        F       accel_x = zero;
+        F       accel_y = zero;
+        F       accel_z = zero;
+
+        for (int is = 0; is < args.sourceCount; ++is) {
+            const F s_x   = Simd::set1(args.bodyPos[3 * is + 0]);
+            const F s_y   = Simd::set1(args.bodyPos[3 * is + 1]);
+            const F s_z   = Simd::set1(args.bodyPos[3 * is + 2]);
+            const F mass  = Simd::select(Simd::cmpeqi(t_idx, Simd::set1i(is)), zero, Simd::set1(args.bodyMass[is]));
+            const F dist2 = distance2<Simd>(s_x, s_y, s_z, t_x, t_y, t_z);
+            const F denom = Simd::add(Simd::mul(dist2, Simd::sqrt(dist2)), softening);
+            accel_x       = Simd::add(accel_x, Simd::mul(Simd::div(Simd::sub(s_x, t_x), denom), mass));
+            accel_y       = Simd::add(accel_y, Simd::mul(Simd::div(Simd::sub(s_y, t_y), denom), mass));
+            accel_z       = Simd::add(accel_z, Simd::mul(Simd::div(Simd::sub(s_z, t_z), denom), mass));
+        }
+
+        Simd::store(group_accel_x, accel_x);
+        Simd::store(group_accel_y, accel_y);
+        Simd::store(group_accel_z, accel_z);
+        for (int i = 0; i < group_count; ++i) {
+            args.bodyAccel[3 * (group_begin + i) + 0] += group_accel_x[i];
+            args.bodyAccel[3 * (group_begin + i) + 1] += group_accel_y[i];
+            args.bodyAccel[3 * (group_begin + i) + 2] += group_accel_z[i];
+        }
+    }
+}
+
+// The vectorized counterpart of the scalar loop of `NBodySim::applyAnalyticGravAccels` and of `NBodySim::findAnalyticRetardedPos`.
+// The lanes hold a group of consecutive targets, whose accelerations stay in registers while they sum all the sources in their
+// order, each broadcast to all the lanes. The lanes whose extrapolation is not accurate enough call the fallback one by one, and
+// take the acceleration it returns. The arithmetic follows the scalar code, so the results are identical.
+//
+template<typename Simd> AnalyticGravityKernelCounts applyAnalyticGravity(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd)
+{
+    using F = typename Simd::F;
+    using I = typename Simd::I;
+    using M = typename Simd::M;
+
+    constexpr int Width = Simd::Width;
+
+    const I zero_i    = Simd::set1i(0);
+    const I one_i     = Simd::set1i(1);
+    const F zero      = Simd::set1(0.0f);
+    const F half      = Simd::set1(0.5f);
+    const F two       = Simd::set1(2.0f);
+    const F four      = Simd::set1(4.0f);
+    const F c2        = Simd::set1(args.lightSpeedSq);
+    const F c2_inv    = Simd::set1(args.lightSpeedInvSq);
+    const F softening = Simd::set1(args.gravSoftening);
+    const F bound     = Simd::set1(args.jerkBound);
+
+    AnalyticGravityKernelCounts counts{};
+
+    alignas(64) float group_x[Width];
+    alignas(64) float group_y[Width];
+    alignas(64) float group_z[Width];
+    alignas(64) int   group_target[Width];
+    alignas(64) float lane_accel_x[Width];
+    alignas(64) float lane_accel_y[Width];
+    alignas(64) float lane_accel_z[Width];
+    alignas(64) float lane_past_time[Width];
+    alignas(64) int   lane_fallback[Width];
+
+    for (int group_begin = targetBegin; group_begin < targetEnd; group_begin += Width) {
+        const int group_count = (targetEnd - group_begin < Width) ? targetEnd - group_begin : Width;
+
+        // The lanes past the end of the range repeat its first target, and are neither stored nor handed to the fallback.
+        for (int i = 0; i < Width; ++i) {
+            const int it    = group_begin + (i < group_count ? i : 0);
+            group_x[i]      = args.bodyPos[3 * it + 0];
+            group_y[i]      = args.bodyPos[3 * it + 1];
+            group_z[i]      = args.bodyPos[3 * it + 2];
+            group_target[i] = (i < group_count) ? it : -1;
+            lane_accel_x[i] = args.bodyAccel[3 * it + 0];
+            lane_accel_y[i] = args.bodyAccel[3 * it + 1];
+            lane_accel_z[i] = args.bodyAccel[3 * it + 2];
+        }
+
+        const F t_x     = Simd::load(group_x);
+        const F t_y     = Simd::load(group_y);
+        const F t_z     = Simd::load(group_z);
+        const I t_idx   = Simd::loadi(group_target);
+        const M inside  = Simd::cmplti(Simd::set1i(-1), t_idx);
+        F       accel_x = Simd::load(lane_accel_x);
+        F       accel_y = Simd::load(lane_accel_y);
+        F       accel_z = Simd::load(lane_accel_z);
+
+        for (int is = 0; is < args.sourceCount; ++is) {
+            const float* const s_pos   = args.bodyPos + 3 * is;
+            const float* const s_vel   = args.bodyVel + 3 * is;
+            const float* const s_accel = args.bodyAccelPrev + 3 * is;
+            const float        speed2  = s_vel[0] * s_vel[0] + s_vel[1] * s_vel[1] + s_vel[2] * s_vel[2];
+            const float        jerk    = args.bodyJerk[is];
+
+            const F s_x = Simd::set1(s_pos[0]);
+            const F s_y = Simd::set1(s_pos[1]);
+            const F s_z = Simd::set1(s_pos[2]);
+            const F v_x = Simd::set1(s_vel[0]);
+            const F v_y = Simd::set1(s_vel[1]);
+            const F v_z = Simd::set1(s_vel[2]);
+            const F a_x = Simd::set1(s_accel[0]);
+            const F a_y = Simd::set1(s_accel[1]);
+            const F a_z = Simd::set1(s_accel[2]);
+
+            const F sep_x   = Simd::sub(t_x, s_x);
+            const F sep_y   = Simd::sub(t_y, s_y);
+            const F sep_z   = Simd::sub(t_z, s_z);
+            const F dist2   = Simd::add(Simd::add(Simd::mul(sep_x, sep_x), Simd::mul(sep_y, sep_y)), Simd::mul(sep_z, sep_z));
+            const F sep_acc = Simd::add(Simd::add(Simd::mul(sep_x, a_x), Simd::mul(sep_y, a_y)), Simd::mul(sep_z, a_z));
+            const F sep_vel = Simd::add(Simd::add(Simd::mul(sep_x, v_x), Simd::mul(sep_y, v_y)), Simd::mul(sep_z, v_z));
+            const F quad    = Simd::sub(Simd::set1(speed2), sep_acc);
+            const F lin     = Simd::sub(c2, Simd::mul(two, sep_vel));
+            const F disc    = Simd::sub(Simd::mul(lin, lin), Simd::mul(Simd::mul(four, quad), dist2));
+            const M valid   = (speed2 > args.maxSpeedSq) ? Simd::cmplt(zero, zero) : Simd::mandnot(Simd::cmplt(disc, zero), Simd::cmplt(zero, lin));
+
+            // The smaller root of the quadratic, then one Newton step on the whole criterion.
+            F       tau    = Simd::div(Simd::mul(two, dist2), Simd::add(lin, Simd::sqrt(disc)));
+            const F ha_x   = Simd::mul(half, a_x);
+            const F ha_y   = Simd::mul(half, a_y);
+            const F ha_z   = Simd::mul(half, a_z);
+            const F x_x    = Simd::sub(Simd::add(sep_x, Simd::mul(v_x, tau)), Simd::mul(Simd::mul(ha_x, tau), tau));
+            const F x_y    = Simd::sub(Simd::add(sep_y, Simd::mul(v_y, tau)), Simd::mul(Simd::mul(ha_y, tau), tau));
+            const F x_z    = Simd::sub(Simd::add(sep_z, Simd::mul(v_z, tau)), Simd::mul(Simd::mul(ha_z, tau), tau));
+            const F r_x    = Simd::sub(v_x, Simd::mul(a_x, tau));
+            const F r_y    = Simd::sub(v_y, Simd::mul(a_y, tau));
+            const F r_z    = Simd::sub(v_z, Simd::mul(a_z, tau));
+            const F x_len2 = Simd::add(Simd::add(Simd::mul(x_x, x_x), Simd::mul(x_y, x_y)), Simd::mul(x_z, x_z));
+            const F x_rate = Simd::add(Simd::add(Simd::mul(x_x, r_x), Simd::mul(x_y, r_y)), Simd::mul(x_z, r_z));
+            const F slope  = Simd::sub(c2, Simd::mul(two, x_rate));
+            tau            = Simd::select(Simd::cmplt(zero, slope), Simd::sub(tau, Simd::div(Simd::sub(Simd::mul(c2, tau), x_len2), slope)), tau);
+
+            // The lanes which cannot be extrapolated see the source at its current position.
+            const F sb_x = Simd::select(valid, Simd::add(Simd::sub(s_x, Simd::mul(v_x, tau)), Simd::mul(Simd::mul(ha_x, tau), tau)), s_x);
+            const F sb_y = Simd::select(valid, Simd::add(Simd::sub(s_y, Simd::mul(v_y, tau)), Simd::mul(Simd::mul(ha_y, tau), tau)), s_y);
+            const F sb_z = Simd::select(valid, Simd::add(Simd::sub(s_z, Simd::mul(v_z, tau)), Simd::mul(Simd::mul(ha_z, tau), tau)), s_z);
+
+            const F drift     = Simd::mul(Simd::mul(Simd::mul(Simd::mul(Simd::mul(Simd::set1(jerk * jerk), tau), tau), tau), tau), tau);
+            const M accurate  = Simd::mandnot(Simd::cmplt(bound, drift), valid);
+            const M self      = Simd::cmpeqi(t_idx, Simd::set1i(is));
+            const F mass      = Simd::select(self, zero, Simd::set1(args.bodyMass[is]));
+            const F sb_dist2  = distance2<Simd>(sb_x, sb_y, sb_z, t_x, t_y, t_z);
+            const F denom     = Simd::add(Simd::mul(sb_dist2, Simd::sqrt(sb_dist2)), softening);
+            F       contrib_x = Simd::mul(Simd::div(Simd::sub(sb_x, t_x), denom), mass);
+            F       contrib_y = Simd::mul(Simd::div(Simd::sub(sb_y, t_y), denom), mass);
+            F       contrib_z = Simd::mul(Simd::div(Simd::sub(sb_z, t_z), denom), mass);
+
+            const M fallback = Simd::mandnot(Simd::mor(accurate, self), inside);
+            if (args.fallback && Simd::any(fallback)) {
+                Simd::store(lane_accel_x, contrib_x);
+                Simd::store(lane_accel_y, contrib_y);
+                Simd::store(lane_accel_z, contrib_z);
+                Simd::store(lane_past_time, Simd::select(valid, tau, Simd::mul(dist2, c2_inv)));
+                Simd::storeui(lane_fallback, Simd::selecti(fallback, one_i, zero_i));
+                for (int i = 0; i < Width; ++i) {
+                    if (lane_fallback[i]) {
+                        float accel[3] = {0.0f, 0.0f, 0.0f};
+                        ++counts.fallbackCount;
+                        if (!args.fallback(args.fallbackContext, group_begin + i, is, lane_past_time[i], accel) && args.recStart > 0) {
+                            ++counts.outOfWindowCount;
+                        }
+                        lane_accel_x[i] = accel[0];
+                        lane_accel_y[i] = accel[1];
+                        lane_accel_z[i] = accel[2];
+                    }
+                }
+                contrib_x = Simd::load(lane_accel_x);
+                contrib_y = Simd::load(lane_accel_y);
+                contrib_z = Simd::load(lane_accel_z);
+            }
+
+            accel_x = Simd::add(accel_x, contrib_x);
+            accel_y = Simd::add(accel_y, contrib_y);
+            accel_z = Simd::add(accel_z, contrib_z);
+        }
+
+        Simd::store(lane_accel_x, accel_x);
+        Simd::store(lane_accel_y, accel_y);
+        Simd::store(lane_accel_z, accel_z);
+        for (int i = 0; i < group_count; ++i) {
+            args.bodyAccel[3 * (group_begin + i) + 0] = lane_accel_x[i];
+            args.bodyAccel[3 * (group_begin + i) + 1] = lane_accel_y[i];
+            args.bodyAccel[3 * (group_begin + i) + 2] = lane_accel_z[i];
+        }
+    }
+
+    return counts;
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
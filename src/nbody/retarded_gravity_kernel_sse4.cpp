@@ -0,0 +1,112 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "nbody/retarded_gravity_kernel_impl.hpp"
+
+#if RETARDED_GRAVITY_KERNEL_X86
+
+#include <cstring>
+#include <immintrin.h>
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+namespace {
+
+// The SSE4.1 intrinsics used by the kernel: 4 lanes, with the masks held as float vectors and the gathers done lane by lane.
+//
+struct SimdSse4 {
+    constexpr static const int Width = 4;
+
+    using F = __m128;
+    using I = __m128i;
+    using M = __m128;
+
+    static F    set1(float v) { return _mm_set1_ps(v); }
+    static F    load(const float* ptr) { return _mm_load_ps(ptr); }
+    static void store(float* ptr, F v) { _mm_store_ps(ptr, v); }
+    static F    add(F a, F b) { return _mm_add_ps(a, b); }
+    static F    sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F    mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F    div(F a, F b) { return _mm_div_ps(a, b); }
+    static F    sqrt(F a) { return _mm_sqrt_ps(a); }
+    static M    cmplt(F a, F b) { return _mm_cmplt_ps(a, b); }
+    static F    select(M m, F a, F b) { return _mm_blendv_ps(b, a, m); }
+
+    static I set1i(int v) { return _mm_set1_epi32(v); }
+    static I loadi(const int* ptr) { return _mm_load_si128(reinterpret_cast<const __m128i*>(ptr)); }
+    static I addi(I a, I b) { return _mm_add_epi32(a, b); }
+    static I subi(I a, I b) { return _mm_sub_epi32(a, b); }
+    static I muli(I a, I b) { return _mm_mullo_epi32(a, b); }
+    static I andi(I a, I b) { return _mm_and_si128(a, b); }
+    static I mini(I a, I b) { return _mm_min_epi32(a, b); }
+    static I maxi(I a, I b) { return _mm_max_epi32(a, b); }
+    static M cmplti(I a, I b) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, b)); }
+    static M cmpeqi(I a, I b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+    static I selecti(M m, I a, I b) { return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(b), _mm_castsi128_ps(a), m)); }
+
+    static I    ori(I a, I b) { return _mm_or_si128(a, b); }
+    static I    slli(I a, int n) { return _mm_slli_epi32(a, n); }
+    static I    srli(I a, int n) { return _mm_srli_epi32(a, n); }
+    static I    srai(I a, int n) { return _mm_srai_epi32(a, n); }
+    static F    tofloat(I a) { return _mm_cvtepi32_ps(a); }
+    static I    toint(F a) { return _mm_cvttps_epi32(a); }
+    static I    loadui(const void* ptr) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+    static void storeui(void* ptr, I v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v); }
+
+    static M    mand(M a, M b) { return _mm_and_ps(a, b); }
+    static M    mor(M a, M b) { return _mm_or_ps(a, b); }
+    static M    mandnot(M a, M b) { return _mm_andnot_ps(a, b); }
+    static bool any(M m) { return _mm_movemask_ps(m) != 0; }
+
+    static int count(M m)
+    {
+        int n = 0;
+        for (int bits = _mm_movemask_ps(m); bits != 0; bits &= bits - 1) {
+            ++n;
+        }
+        return n;
+    }
+
+    static F gather(const float* base, I idx)
+    {
+        alignas(16) int lane_idx[Width];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lane_idx), idx);
+        return _mm_setr_ps(base[lane_idx[0]], base[lane_idx[1]], base[lane_idx[2]], base[lane_idx[3]]);
+    }
+
+    // Gathers 4 bytes at each of the byte offsets `idx` from `base`.
+    static I gatheri(const char* base, I idx)
+    {
+        alignas(16) int lane_idx[Width];
+        alignas(16) int lane_val[Width];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lane_idx), idx);
+        for (int l = 0; l < Width; ++l) {
+            std::memcpy(&lane_val[l], base + lane_idx[l], sizeof(int));
+        }
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(lane_val));
+    }
+};
+
+}  // namespace
+
+int applyRetardedGravitySse4(const RetardedGravityKernelArgs& args, int targetBegin, int targetEnd) { return applyRetardedGravity<SimdSse4>(args, targetBegin, targetEnd); }
+
+void applyNewtonianGravitySse4(const NewtonianGravityKernelArgs& args, int targetBegin, int targetEnd) { applyNewtonianGravity<SimdSse4>(args, targetBegin, targetEnd); }
+
+AnalyticGravityKernelCounts applyAnalyticGravitySse4(const AnalyticGravityKernelArgs& args, int targetBegin, int targetEnd) { return applyAnalyticGravity<SimdSse4>(args, targetBegin, targetEnd); }
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+#endif
@@ -0,0 +1,281 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#include "nbody/retarded_octree.hpp"
+
+#include "nbody/nbody_sim.hpp"
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+RetardedOctree::RetardedOctree(bool withQuadrupoles)
+    : _withQuadrupoles{withQuadrupoles}
+{
+}
+
+// Builds the cells from scratch and reconstructs their histories, in all the levels, from the recorded positions of the member
+// bodies, which are the sources: the tracers keep no history.
+//
+void RetardedOctree::rebuild(const NBodySim& sim)
+{
+    const int sourceCount = sim.sourceCount();
+
+    _bodyOrder.resize(sourceCount);
+    std::iota(_bodyOrder.begin(), _bodyOrder.end(), 0);
+    _cells.clear();
+
+    if (sourceCount > 0) {
+        vec3 boundsMin = sim.bodyPositions()[0];
+        vec3 boundsMax = sim.bodyPositions()[0];
+        for (const vec3& pos : sim.bodyPositions().first(sourceCount)) {
+            boundsMin = glm::min(boundsMin, pos);
+            boundsMax = glm::max(boundsMax, pos);
+        }
+        const vec3  extent   = boundsMax - boundsMin;
+        const float halfSize = 0.5f * std::max({extent.x, extent.y, extent.z}) + 1e-3f;
+        buildCell(sim, 0, sourceCount, 0.5f * (boundsMin + boundsMax), halfSize, 0);
+    }
+
+    const int cellCount = (int)_cells.size();
+    const int slotCount = sim._histLevelCount * sim._recordCount;
+    _histComMat.reset({slotCount, cellCount});
+    if (_withQuadrupoles) {
+        _histQuadMat.reset({slotCount, cellCount});
+    }
+
+    // The moments of a record are computed once, and recorded in each level holding it.
+    for (int ir = sim.oldestRecordIdx(); ir <= sim._recordIdx; ++ir) {
+        bool computed = false;
+        sim.forEachRecordSlot(ir, [&](int slot) {
+            if (!computed) {
+                computeMoments(sim, [&](int ib) { return sim.histPos(slot, ib); }, _comScratch, _withQuadrupoles ? &_quadScratch : nullptr);
+                computed = true;
+            }
+            recordMoments(slot);
+        });
+    }
+
+    _builtRecordIdx = sim._recordIdx;
+    refit(sim);
+}
+
+// Refits the cells to the current body positions and records their centers of mass, in each level holding the newest record.
+// The tree gets rebuilt once its cells have drifted for too long, or the set of sources has changed.
+//
+void RetardedOctree::update(const NBodySim& sim)
+{
+    if (sim._recordIdx - _builtRecordIdx >= RebuildRecordInterval || (int)_bodyOrder.size() != sim.sourceCount()) {
+        rebuild(sim);
+        return;
+    }
+
+    refit(sim);
+}
+
+// Follows a reordering of the bodies, given the new index of each body. The cells keep their members and their histories.
+//
+void RetardedOctree::remapBodies(std::span<const int> newBodyIdxArr)
+{
+    for (int& ib : _bodyOrder) {
+        ib = newBodyIdxArr[ib];
+    }
+}
+
+void RetardedOctree::applyGravAccels(NBodySim& sim) const
+{
+    const auto body_accel_arr = sim._bodies.field<&NBodySim::Body::accel>();
+    sim._threadPool->parallelFor(sim.bodyCount(), sim.BarnesHutChunkSize, [&](int begin, int end) {
+        for (int ib = begin; ib < end; ++ib) {
+            body_accel_arr[ib] += computeGravAccel(sim, ib);
+        }
+    });
+}
+
+vec3 RetardedOctree::computeGravAccel(const NBodySim& sim, int target_body_idx) const
+{
+    const vec3  target_pos   = sim.bodyPositions()[target_body_idx];
+    const float openingAngle = sim._openingAngle;
+    const int   cellCount    = (int)_cells.size();
+    vec3        accel{};
+
+    for (int ic = 0; ic < cellCount;) {
+        const Cell& cell  = _cells[ic];
+        const float dist2 = glm::distance2(target_pos, cell.com);
+        const float dist  = std::sqrt(dist2);
+
+        if (cell.radius < openingAngle * dist && cell.radius < dist) {
+            // The cell is far enough to act as a single source at its retarded center of mass.
+            int   hist_record_idx = sim.guessRecordIdx(sim.lightDelay(dist2), sim._histLevelCount);
+            float hist_alpha      = 0.0f;
+            vec3  sb_pos{};
+            if (sim.findRetardedPos(target_pos, _histComMat.row(ic), hist_record_idx, hist_alpha, sb_pos, sim._histLevelCount)) {
+                accel += NBodySim::gravAccel(target_pos, sb_pos, cell.mass);
+            }
+            ic = cell.skip;
+
+        } else if (cell.isLeaf) {
+            // The cell is too close to be approximated: interact with each member body on its own.
+            for (int i = cell.bodyBegin; i < cell.bodyEnd; ++i) {
+                const int is = _bodyOrder[i];
+                if (is != target_body_idx) {
+                    accel += sim.computePairGravAccel(target_pos, is);
+                }
+            }
+            ic = cell.skip;
+
+        } else {
+            ++ic;
+        }
+    }
+
+    return accel;
+}
+
+// Appends the cell covering the given bodies and, recursively, its subcells in the depth-first order.
+//
+int RetardedOctree::buildCell(const NBodySim& sim, int bodyBegin, int bodyEnd, vec3 center, float halfSize, int depth)
+{
+    const int cellIdx = (int)_cells.size();
+
+    float mass = 0.0f;
+    for (int i = bodyBegin; i < bodyEnd; ++i) {
+        mass += sim.bodyMasses()[_bodyOrder[i]];
+    }
+
+    const bool isLeaf = (bodyEnd - bodyBegin) <= LeafCapacity || depth >= MaxDepth;
+    _cells.push_back(Cell{.bodyBegin = bodyBegin, .bodyEnd = bodyEnd, .skip = 0, .isLeaf = isLeaf, .mass = mass, .radius = 0.0f, .com = center});
+
+    if (!isLeaf) {
+        // Partition the bodies into octants: by x into halves, then by y into quarters, then by z into eighths.
+        // The octant index has bits 4, 2 and 1 set for the upper halves along x, y and z respectively.
+        const auto posOf = [&](int ib) { return sim.bodyPositions()[ib]; };
+
+        std::array<vector<int>::iterator, 9> bounds;
+        bounds[0] = _bodyOrder.begin() + bodyBegin;
+        bounds[8] = _bodyOrder.begin() + bodyEnd;
+        bounds[4] = std::partition(bounds[0], bounds[8], [&](int ib) { return posOf(ib).x < center.x; });
+        for (int i = 0; i < 8; i += 4) {
+            bounds[i + 2] = std::partition(bounds[i], bounds[i + 4], [&](int ib) { return posOf(ib).y < center.y; });
+        }
+        for (int i = 0; i < 8; i += 2) {
+            bounds[i + 1] = std::partition(bounds[i], bounds[i + 2], [&](int ib) { return posOf(ib).z < center.z; });
+        }
+
+        const float childHalfSize = 0.5f * halfSize;
+        for (int octant = 0; octant < 8; ++octant) {
+            if (bounds[octant] == bounds[octant + 1]) {
+                continue;
+            }
+            const vec3 childCenter = center + childHalfSize * vec3{(octant & 4) ? 1.0f : -1.0f, (octant & 2) ? 1.0f : -1.0f, (octant & 1) ? 1.0f : -1.0f};
+            buildCell(sim, (int)(bounds[octant] - _bodyOrder.begin()), (int)(bounds[octant + 1] - _bodyOrder.begin()), childCenter, childHalfSize, depth + 1);
+        }
+    }
+
+    _cells[cellIdx].skip = (int)_cells.size();
+    return cellIdx;
+}
+
+void RetardedOctree::refit(const NBodySim& sim)
+{
+    const int cellCount = (int)_cells.size();
+
+    computeMoments(sim, [&](int ib) { return sim.bodyPositions()[ib]; }, _comScratch, _withQuadrupoles ? &_quadScratch : nullptr);
+    sim.forEachRecordSlot(sim._recordIdx, [&](int slot) { recordMoments(slot); });
+
+    // Visit the cells bottom-up, so that the children are refitted before their parent.
+    for (int ic = cellCount - 1; ic >= 0; --ic) {
+        Cell& cell = _cells[ic];
+        cell.com   = _comScratch[ic];
+
+        float radius = 0.0f;
+        if (cell.isLeaf) {
+            for (int i = cell.bodyBegin; i < cell.bodyEnd; ++i) {
+                radius = std::max(radius, glm::distance(cell.com, sim.bodyPositions()[_bodyOrder[i]]));
+            }
+        } else {
+            for (int ich = ic + 1; ich < cell.skip; ich = _cells[ich].skip) {
+                radius = std::max(radius, _cells[ich].radius + glm::distance(cell.com, _cells[ich].com));
+            }
+        }
+        cell.radius = radius;
+    }
+}
+
+void RetardedOctree::recordMoments(int slot)
+{
+    const int cellCount = (int)_cells.size();
+    for (int ic = 0; ic < cellCount; ++ic) {
+        _histComMat({slot, ic}) = _comScratch[ic];
+    }
+    if (_withQuadrupoles) {
+        for (int ic = 0; ic < cellCount; ++ic) {
+            _histQuadMat({slot, ic}) = _quadScratch[ic];
+        }
+    }
+}
+
+// Computes the centers of mass and, if requested, the quadrupole moments of all the cells for the body positions given by `bodyPos`.
+// Massless cells are placed at the plain average of their members.
+//
+template<typename PosFn> void RetardedOctree::computeMoments(const NBodySim& sim, PosFn&& bodyPos, vector<vec3>& coms, vector<SymMat3>* quads) const
+{
+    const int cellCount = (int)_cells.size();
+    coms.resize(cellCount);
+    if (quads) {
+        quads->resize(cellCount);
+    }
+
+    for (int ic = cellCount - 1; ic >= 0; --ic) {
+        const Cell& cell = _cells[ic];
+
+        vec3 weightedSum{};
+        vec3 plainSum{};
+        if (cell.isLeaf) {
+            for (int i = cell.bodyBegin; i < cell.bodyEnd; ++i) {
+                const int  ib  = _bodyOrder[i];
+                const vec3 pos = bodyPos(ib);
+                weightedSum += sim.bodyMasses()[ib] * pos;
+                plainSum += pos;
+            }
+        } else {
+            for (int ich = ic + 1; ich < cell.skip; ich = _cells[ich].skip) {
+                const int memberCount = _cells[ich].bodyEnd - _cells[ich].bodyBegin;
+                weightedSum += _cells[ich].mass * coms[ich];
+                plainSum += (float)memberCount * coms[ich];
+            }
+        }
+
+        const vec3 com = (cell.mass > 0.0f) ? weightedSum / cell.mass : plainSum / (float)(cell.bodyEnd - cell.bodyBegin);
+        coms[ic]       = com;
+
+        if (quads) {
+            // The quadrupole of a parent is the sum of its children's, shifted to its own center by the parallel axis theorem.
+            SymMat3 quad{};
+            if (cell.isLeaf) {
+                for (int i = cell.bodyBegin; i < cell.bodyEnd; ++i) {
+                    const int ib = _bodyOrder[i];
+                    quad += SymMat3::quadrupole(bodyPos(ib) - com, sim.bodyMasses()[ib]);
+                }
+            } else {
+                for (int ich = ic + 1; ich < cell.skip; ich = _cells[ich].skip) {
+                    quad += (*quads)[ich];
+                    quad += SymMat3::quadrupole(coms[ich] - com, _cells[ich].mass);
+                }
+            }
+            (*quads)[ic] = quad;
+        }
+    }
+}
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
@@ -0,0 +1,110 @@
+/*
+    MIT License
+    Copyright (c) 2025 Mariusz Łapiński
+
+      ▄█     ▄████████    ▄████████    ▄▄▄▄███▄▄▄▄      ▄████████    ▄████████  ▄█   ▄██████▄  ███▄▄▄▄
+      ███    ███    ███   ███    ███  ▄██▀▀▀███▀▀▀██▄   ███    ███   ███    ███ ███  ███    ███ ███▀▀▀██▄
+      ███▌   ███    █▀    ███    ███  ███   ███   ███   ███    █▀    ███    ███ ███▌ ███    ███ ███   ███
+      ███▌   ███          ███    ███  ███   ███   ███  ▄███▄▄▄      ▄███▄▄▄▄██▀ ███▌ ███    ███ ███   ███
+      ███▌ ▀███████████ ▀███████████  ███   ███   ███ ▀▀███▀▀▀     ▀▀███▀▀▀▀▀   ███▌ ███    ███ ███   ███
+      ███           ███   ███    ███  ███   ███   ███   ███    █▄  ▀███████████ ███  ███    ███ ███   ███
+      ███     ▄█    ███   ███    ███  ███   ███   ███   ███    ███   ███    ███ ███  ███    ███ ███   ███
+      █▀    ▄████████▀    ███    █▀    ▀█   ███   █▀    ██████████   ███    ███ █▀    ▀██████▀   ▀█   █▀
+                                                                    ███    ███
+*/
+
+#pragma once
+
+#include "core/basic_types.hpp"
+#include "core/matrix.hpp"
+
+class NBodySim;
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A symmetric 3x3 matrix, such as a quadrupole moment or a tidal tensor.
+//
+struct SymMat3 {
+    float xx, yy, zz, xy, xz, yz;
+
+    vec3 operator*(const vec3& v) const { return vec3{xx * v.x + xy * v.y + xz * v.z, xy * v.x + yy * v.y + yz * v.z, xz * v.x + yz * v.y + zz * v.z}; }
+
+    SymMat3& operator+=(const SymMat3& m)
+    {
+        xx += m.xx, yy += m.yy, zz += m.zz, xy += m.xy, xz += m.xz, yz += m.yz;
+        return *this;
+    }
+
+    static SymMat3 lerp(const SymMat3& m0, const SymMat3& m1, float alpha)
+    {
+        const auto mix = [=](float a, float b) { return a + (b - a) * alpha; };
+        return SymMat3{mix(m0.xx, m1.xx), mix(m0.yy, m1.yy), mix(m0.zz, m1.zz), mix(m0.xy, m1.xy), mix(m0.xz, m1.xz), mix(m0.yz, m1.yz)};
+    }
+
+    // Returns `scale` * v vᵀ + `diagonal` * I.
+    static SymMat3 outer(const vec3& v, float scale, float diagonal)
+    {
+        return SymMat3{
+            scale * v.x * v.x + diagonal, scale * v.y * v.y + diagonal, scale * v.z * v.z + diagonal, scale * v.x * v.y, scale * v.x * v.z, scale * v.y * v.z,
+        };
+    }
+
+    // Returns `scale` * (3 v vᵀ - |v|² I): the traceless quadrupole moment of a point mass `scale` displaced by `v`.
+    static SymMat3 quadrupole(const vec3& v, float scale) { return outer(v, 3.0f * scale, -scale * glm::length2(v)); }
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---
+
+// A Barnes-Hut octree whose cells record the history of their own centers of mass, so that a distant group of bodies
+// acts on a target as a single point source, seen at the retarded time of the group rather than of each member.
+//
+// The cell membership is fixed between rebuilds, which keeps the history of each cell a continuous world line.
+// In between, the cells are refitted every step: their centers of mass and bounding radii follow the member bodies.
+// Optionally, the cells also record the history of their quadrupole moments around the center of mass.
+// The cell histories hold the same levels as those of the bodies, so that the distant cells stay in view as far as the bodies.
+// The tracers are left out of the tree, as they attract nothing, but the walk still computes their accelerations.
+//
+class RetardedOctree
+{
+public:
+    const int LeafCapacity          = 8;
+    const int MaxDepth              = 20;
+    const int RebuildRecordInterval = 32;
+
+    struct Cell {
+        int   bodyBegin;  // Range of the member bodies in `_bodyOrder`.
+        int   bodyEnd;
+        int   skip;  // Index of the cell following this cell's subtree in the depth-first order.
+        bool  isLeaf;
+        float mass;
+        float radius;  // Radius of the sphere around `com` enclosing all the member bodies.
+        vec3  com;
+    };
+
+    const bool      _withQuadrupoles;
+    vector<int>     _bodyOrder;
+    vector<Cell>    _cells;
+    Matrix<vec3>    _histComMat;
+    Matrix<SymMat3> _histQuadMat;
+    vector<vec3>    _comScratch;
+    vector<SymMat3> _quadScratch;
+    int             _builtRecordIdx = 0;
+
+public:
+    explicit RetardedOctree(bool withQuadrupoles = false);
+
+    void rebuild(const NBodySim& sim);
+    void update(const NBodySim& sim);
+    void remapBodies(std::span<const int> newBodyIdxArr);
+    void applyGravAccels(NBodySim& sim) const;
+    vec3 computeGravAccel(const NBodySim& sim, int target_body_idx) const;
+
+private:
+    int  buildCell(const NBodySim& sim, int bodyBegin, int bodyEnd, vec3 center, float halfSize, int depth);
+    void refit(const NBodySim& sim);
+    void recordMoments(int slot);
+
+    template<typename PosFn> void computeMoments(const NBodySim& sim, PosFn&& bodyPos, vector<vec3>& coms, vector<SymMat3>* quads) const;
+};
+
+// ---―--―-――-―――-―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――-―――-――-―--―---